@@ -29,18 +29,16 @@
 #include "deepstream_app.h"
 
 #define MAX_DISPLAY_LEN 64
-static guint batch_num = 0;
-static guint demux_batch_num = 0;
-static struct track_buf past_frame;
-static struct track_buf present_frame; 
-static struct track_buf present_frame_best;
-
-extern tracked_data tracking_output;
 
 GST_DEBUG_CATEGORY_EXTERN (NVDS_APP);
 
 GQuark _dsmeta_quark;
 
+const gchar *latency_component_names[NV_DS_LATENCY_NUM_COMPONENTS] = {
+  "frame", "demux-frame", "capture-pgie", "to-analytics", "to-tiler",
+  "to-osd", "to-sink"
+};
+
 #define CEIL(a,b) ((a + b - 1) / b)
 
 /**
@@ -69,6 +67,47 @@ static gboolean add_and_link_broker_sink (AppCtx * appCtx);
  */
 static gboolean is_sink_available_for_source_id(NvDsConfig *config, guint source_id);
 
+/**
+ * One step of the adaptive primary GIE interval, from the main loop.
+ */
+static gboolean
+adapt_pgie_interval (gpointer data)
+{
+  AppCtx *appCtx = (AppCtx *) data;
+  NvDsPerfSnapshot perf;
+  guint interval = interval_ctl_interval (&appCtx->interval_ctl);
+
+  perf_slot_read (&appCtx->perf_slot, &perf);
+  if (interval_ctl_update (&appCtx->interval_ctl, appCtx->latency_reporter,
+          NV_DS_LATENCY_FRAME,
+          appCtx->config.enable_perf_measurement ? &perf : NULL) != interval)
+    g_object_set (G_OBJECT (appCtx->pipeline.common_elements.
+            primary_gie_bin.primary_gie), "interval",
+        interval_ctl_interval (&appCtx->interval_ctl), NULL);
+  return TRUE;
+}
+
+/**
+ * Index of the source bin an element belongs to, or with @p outputs also
+ * of the demuxed output bin. -1 for elements shared by all sources.
+ */
+static gint
+find_source_index (AppCtx * appCtx, GstElement * elem, gboolean outputs)
+{
+  NvDsSrcParentBin *bin = &appCtx->pipeline.multi_src_bin;
+  guint i;
+
+  for (; elem; elem = GST_ELEMENT_PARENT (elem)) {
+    for (i = 0; i < bin->num_bins; i++) {
+      if (bin->sub_bins[i].src_elem == elem || bin->sub_bins[i].bin == elem)
+        return i;
+      if (outputs && appCtx->pipeline.demux_instance_bins[i].bin == elem)
+        return i;
+    }
+  }
+  return -1;
+}
+
 /**
  * callback function to receive messages from components
  * in the pipeline.
@@ -110,7 +149,6 @@ bus_callback (GstBus * bus, GstMessage * message, gpointer data)
     case GST_MESSAGE_ERROR:{
       GError *error = NULL;
       gchar *debuginfo = NULL;
-      guint i = 0;
       gst_message_parse_error (message, &error, &debuginfo);
       g_printerr ("ERROR from %s: %s\n",
           GST_OBJECT_NAME (message->src), error->message);
@@ -119,24 +157,14 @@ bus_callback (GstBus * bus, GstMessage * message, gpointer data)
       }
 
       NvDsSrcParentBin *bin = &appCtx->pipeline.multi_src_bin;
-      GstElement *msg_src_elem = (GstElement *) GST_MESSAGE_SRC (message);
-      gboolean bin_found = FALSE;
       /* Find the source bin which generated the error. */
-      while (msg_src_elem && !bin_found) {
-        for (i = 0; i < bin->num_bins && !bin_found; i++) {
-          if (bin->sub_bins[i].src_elem == msg_src_elem ||
-                  bin->sub_bins[i].bin == msg_src_elem) {
-            bin_found = TRUE;
-            break;
-          }
-        }
-        msg_src_elem = GST_ELEMENT_PARENT (msg_src_elem);
-      }
+      gint source_id = find_source_index (appCtx,
+          (GstElement *) GST_MESSAGE_SRC (message), FALSE);
 
-      if ((i != bin->num_bins) &&
+      if (source_id >= 0 &&
           (appCtx->config.multi_source_config[0].type == NV_DS_SOURCE_RTSP)) {
         // Error from one of RTSP source.
-        NvDsSrcBin *subBin = &bin->sub_bins[i];
+        NvDsSrcBin *subBin = &bin->sub_bins[source_id];
 
         if (!subBin->reconfiguring ||
             g_strrstr(debuginfo, "500 (Internal Server Error)")) {
@@ -164,6 +192,15 @@ bus_callback (GstBus * bus, GstMessage * message, gpointer data)
       appCtx->quit = TRUE;
       break;
     }
+    case GST_MESSAGE_QOS:{
+      /* Frames dropped or late in the tiled or single stream output carry
+       * every source and are accounted to the output. */
+      gint source_id = find_source_index (appCtx,
+          (GstElement *) GST_MESSAGE_SRC (message), TRUE);
+      frame_counts_add_qos (appCtx->frame_counts,
+          source_id >= 0 ? (guint) source_id : FRAME_COUNTS_OUTPUT, message);
+      break;
+    }
     case GST_MESSAGE_STATE_CHANGED:{
       GstState oldstate, newstate;
       gst_message_parse_state_changed (message, &oldstate, &newstate, NULL);
@@ -218,30 +255,53 @@ bus_callback (GstBus * bus, GstMessage * message, gpointer data)
   return TRUE;
 }
 
+/**
+ * Function to append the objects of every frame of the batch to a columnar
+ * detection log instead of one KITTI file per frame. Frames without objects
+ * are recorded too, as the text format writes an empty file for them.
+ */
+static void
+write_detlog (NvDsDetLog * log, NvDsBatchMeta * batch_meta)
+{
+  for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
+      l_frame = l_frame->next) {
+    NvDsFrameMeta *frame_meta = l_frame->data;
+
+    if (!frame_meta->obj_meta_list)
+      detlog_append_empty_frame (log, frame_meta->frame_num,
+          frame_meta->pad_index);
+    for (NvDsMetaList * l_obj = frame_meta->obj_meta_list; l_obj != NULL;
+        l_obj = l_obj->next) {
+      NvDsObjectMeta *obj = (NvDsObjectMeta *) l_obj->data;
+      detlog_append (log, frame_meta->frame_num, frame_meta->pad_index,
+          obj->unique_component_id, obj->class_id, obj->obj_label,
+          obj->object_id, obj->rect_params.left, obj->rect_params.top,
+          obj->rect_params.width, obj->rect_params.height);
+    }
+  }
+}
+
 /**
  * Function to dump bounding box data in kitti format. For this to work,
  * property "gie-kitti-output-dir" must be set in configuration file.
  * Data of different sources and frames is dumped in separate file.
+ * Files are only formatted here and written by the kitti writer thread.
  */
 static void write_kitti_output (AppCtx * appCtx, NvDsBatchMeta * batch_meta)
 {
-  gchar bbox_file[1024] = { 0 };
-  FILE *bbox_params_dump_file = NULL;
+  if (!appCtx->config.bbox_dir_path || !appCtx->kitti_writer)
+    return;
 
-  if (!appCtx->config.bbox_dir_path)
+  if (appCtx->gie_log) {
+    write_detlog (appCtx->gie_log, batch_meta);
     return;
+  }
 
   for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
       l_frame = l_frame->next) {
     NvDsFrameMeta *frame_meta = l_frame->data;
     guint stream_id = frame_meta->pad_index;
-    g_snprintf (bbox_file, sizeof (bbox_file) - 1,
-        "%s/%02u_%03u_%06lu.txt", appCtx->config.bbox_dir_path,
-        appCtx->index, stream_id, (gulong) frame_meta->frame_num);
-    bbox_params_dump_file = fopen (bbox_file, "w");
-    if (!bbox_params_dump_file)
-      continue;
-      
+    GString *data = g_string_sized_new (1024);
 
     for (NvDsMetaList * l_obj = frame_meta->obj_meta_list; l_obj != NULL;
         l_obj = l_obj->next) {
@@ -250,26 +310,50 @@ static void write_kitti_output (AppCtx * appCtx, NvDsBatchMeta * batch_meta)
       float top = obj->rect_params.top;
       float right = left + obj->rect_params.width;
       float bottom = top + obj->rect_params.height;
-      fprintf (bbox_params_dump_file,
+      g_string_append_printf (data,
           "%s 0.0 0 0.0 %f %f %f %f 0.0 0.0 0.0 0.0 0.0 0.0 0.0\n",
           obj->obj_label, left, top, right, bottom);
     }
-    fclose (bbox_params_dump_file);
+    kitti_writer_push (appCtx->kitti_writer, KITTI_WRITER_GIE,
+        g_strdup_printf ("%s/%02u_%03u_%06lu.txt",
+            appCtx->config.bbox_dir_path, appCtx->index, stream_id,
+            (gulong) frame_meta->frame_num), data, FALSE);
   }
 }
 
+typedef struct
+{
+  guint64 key;
+  guint stream_id;
+  guint frame_num;
+  GString *data;
+} NvDsKittiPastFrame;
+
+static void
+past_frame_free (gpointer data)
+{
+  NvDsKittiPastFrame *frame = data;
+  if (frame->data)
+    g_string_free (frame->data, TRUE);
+  g_free (frame);
+}
+
 /**
  * Function to dump past frame objs in kitti format.
+ * The tracker reports past frame objects track by track, so they are first
+ * grouped by stream and frame; each frame file then gets a single append
+ * from the kitti writer thread.
  */
 static void write_kitti_past_track_output (AppCtx * appCtx, NvDsBatchMeta * batch_meta)
 {
-  if (!appCtx->config.kitti_track_dir_path)
+  GHashTable *frames = NULL;
+  GHashTableIter iter;
+  NvDsKittiPastFrame *frame;
+
+  if (!appCtx->config.kitti_track_dir_path || !appCtx->kitti_writer)
     return;
 
   // dump past frame tracked objects appending current frame objects
-  gchar bbox_file[1024] = { 0 };
-  FILE *bbox_params_dump_file = NULL;
-
     NvDsPastFrameObjBatch *pPastFrameObjBatch = NULL;
     NvDsUserMetaList *bmeta_list = NULL;
     NvDsUserMeta *user_meta = NULL;
@@ -284,138 +368,197 @@ static void write_kitti_past_track_output (AppCtx * appCtx, NvDsBatchMeta * batc
             NvDsPastFrameObjList *objList = (objStream->list) + li;
             for (uint oi=0; oi<objList->numObj; oi++) {
               NvDsPastFrameObj *obj = (objList->list) + oi;
-              g_snprintf (bbox_file, sizeof (bbox_file) - 1,
-                "%s/%02u_%03u_%06lu.txt", appCtx->config.kitti_track_dir_path,
-                appCtx->index, stream_id, (gulong) obj->frameNum);
+              guint64 key = ((guint64) stream_id << 32) | obj->frameNum;
+
+              if (appCtx->track_log) {
+                detlog_append (appCtx->track_log, obj->frameNum, stream_id,
+                    appCtx->config.primary_gie_config.unique_id,
+                    objList->classId, objList->objLabel, objList->uniqueId,
+                    obj->tBbox.left, obj->tBbox.top, obj->tBbox.width,
+                    obj->tBbox.height);
+                continue;
+              }
+
+              if (!frames)
+                frames = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                    NULL, past_frame_free);
+              frame = g_hash_table_lookup (frames, &key);
+              if (!frame) {
+                frame = g_new (NvDsKittiPastFrame, 1);
+                frame->key = key;
+                frame->stream_id = stream_id;
+                frame->frame_num = obj->frameNum;
+                frame->data = g_string_sized_new (256);
+                g_hash_table_insert (frames, &frame->key, frame);
+              }
 
               float left = obj->tBbox.left;
               float right = left + obj->tBbox.width;
               float top = obj->tBbox.top;
               float bottom = top + obj->tBbox.height;
-              bbox_params_dump_file = fopen (bbox_file, "a");
-              if (!bbox_params_dump_file){
-                continue;
-              }
-              fprintf(bbox_params_dump_file,
+              g_string_append_printf (frame->data,
                 "%s %lu 0.0 0 0.0 %f %f %f %f 0.0 0.0 0.0 0.0 0.0 0.0 0.0\n",
                 objList->objLabel, objList->uniqueId, left, top, right, bottom);
-              fclose (bbox_params_dump_file);
             }
           }
         }
       }
     }
+
+  if (!frames)
+    return;
+
+  g_hash_table_iter_init (&iter, frames);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & frame)) {
+    kitti_writer_push (appCtx->kitti_writer, KITTI_WRITER_TRACK,
+        g_strdup_printf ("%s/%02u_%03u_%06lu.txt",
+            appCtx->config.kitti_track_dir_path, appCtx->index,
+            frame->stream_id, (gulong) frame->frame_num), frame->data, TRUE);
+    frame->data = NULL;
+  }
+  g_hash_table_destroy (frames);
 }
 
 /**
  * Function to dump bounding box data in kitti format with tracking ID added.
  * For this to work, property "kitti-track-output-dir" must be set in configuration file.
  * Data of different sources and frames is dumped in separate file.
+ * Files are only formatted here and written by the kitti writer thread.
  */
-
-///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-static void write_kitti_track_output (AppCtx * appCtx, NvDsBatchMeta * batch_meta)
+static void
+write_kitti_track_output (AppCtx * appCtx, NvDsBatchMeta * batch_meta)
 {
-  gchar bbox_file[1024] = { 0 };
-  FILE *bbox_params_dump_file = NULL;
+  if (!appCtx->config.kitti_track_dir_path || !appCtx->kitti_writer)
+    return;
 
-  if (!appCtx->config.kitti_track_dir_path)
+  if (appCtx->track_log) {
+    write_detlog (appCtx->track_log, batch_meta);
     return;
+  }
 
   for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
       l_frame = l_frame->next) {
     NvDsFrameMeta *frame_meta = l_frame->data;
     guint stream_id = frame_meta->pad_index;
-    g_snprintf (bbox_file, sizeof (bbox_file) - 1,
-        "%s/%02u_%03u_%06lu.txt", appCtx->config.kitti_track_dir_path,
-        appCtx->index, stream_id, (gulong) frame_meta->frame_num);
-    bbox_params_dump_file = fopen (bbox_file, "w");
-
-    if (!bbox_params_dump_file)
-      continue;
-    past_frame.fframe=frame_meta->frame_num+1;
-    if((past_frame.fframe==1)||(tracking_output.reset_flag == 1)){
-		  past_frame.centerx=0;
-		  past_frame.centery=0;
-		  past_frame.width=0;
-		  past_frame.height=0;
-		  past_frame.score=1000000;
-		  present_frame_best.fframe=1;
-		  present_frame_best.score=1000000;
-		  tracking_output.detect_flag=0;
-		  tracking_output.reset_flag = 0;
-		  tracking_output.centerx=0;
-		  tracking_output.centery=0;
-		  printf("reset\n");
-		  }
-	
-    if(past_frame.fframe!=present_frame_best.fframe)
-    {
-		if(present_frame_best.score>62500) //r=250 ^2
-		{
-			tracking_output.detect_flag = 0; // loss
-			present_frame_best.score=1000000;
-		}
-		else
-		{
-			past_frame.centerx = past_frame.centerx + present_frame_best.centerx;
-			past_frame.centery = past_frame.centery + present_frame_best.centery;
-			past_frame.width = present_frame_best.width;
-			past_frame.height = present_frame_best.height;
-			past_frame.score = present_frame_best.score;
-			tracking_output.centerx = past_frame.centerx;
-        	tracking_output.centery = -past_frame.centery;
-        	tracking_output.width = past_frame.width;
-        	tracking_output.height = past_frame.height;
-            tracking_output.detect_flag = 1; // find
-	        present_frame_best.score=1000000;
-		}
+    GString *data = g_string_sized_new (1024);
+
+    for (NvDsMetaList * l_obj = frame_meta->obj_meta_list; l_obj != NULL;
+        l_obj = l_obj->next) {
+      NvDsObjectMeta *obj = (NvDsObjectMeta *) l_obj->data;
+      float left = obj->rect_params.left;
+      float top = obj->rect_params.top;
+      float right = left + obj->rect_params.width;
+      float bottom = top + obj->rect_params.height;
+      guint64 id = obj->object_id;
+      g_string_append_printf (data,
+          "%s %lu 0.0 0 0.0 %f %f %f %f 0.0 0.0 0.0 0.0 0.0 0.0 0.0\n",
+          obj->obj_label, id, left, top, right, bottom);
     }
+    kitti_writer_push (appCtx->kitti_writer, KITTI_WRITER_TRACK,
+        g_strdup_printf ("%s/%02u_%03u_%06lu.txt",
+            appCtx->config.kitti_track_dir_path, appCtx->index, stream_id,
+            (gulong) frame_meta->frame_num), data, FALSE);
+  }
+}
 
-    for (NvDsMetaList * l_obj = frame_meta->obj_meta_list; l_obj != NULL; l_obj = l_obj->next) 
-    {
-	    NvDsObjectMeta *obj = (NvDsObjectMeta *) l_obj->data;
-	    present_frame.label=obj->obj_label;
-	    char *per="person";
-	    int result = strcmp(present_frame.label,per);
-	    if(result == 0)
-	    {
-		    float left = obj->rect_params.left;
-		    float top = obj->rect_params.top;
-		    present_frame.centerx = left + (obj->rect_params.width)/2-960-past_frame.centerx;
-		    present_frame.centery = top + (obj->rect_params.height)/2-540-past_frame.centery;
-		    present_frame.width = obj->rect_params.width;
-		    present_frame.height = obj->rect_params.height;
-		    present_frame.score=abs(present_frame.centerx* present_frame.centerx)+abs(present_frame.centery* present_frame.centery);
-		    
-		    if(present_frame_best.score> present_frame.score)
-		    {
-			    present_frame_best.score= present_frame.score;
-			    present_frame_best.centerx= present_frame.centerx;
-			    present_frame_best.centery= present_frame.centery;
-			    present_frame_best.width= present_frame.width;
-			    present_frame_best.height= present_frame.height;
-			    present_frame_best.fframe=frame_meta->frame_num+1;
-		    }
-	    }
+/**
+ * Time a frame has spent in the pipeline so far, from its running time and
+ * the pipeline clock. Returns 0 if it cannot be told.
+ */
+static GstClockTime
+get_frame_latency (AppCtx * appCtx, GstClockTime pts)
+{
+  GstElement *pipeline = appCtx->pipeline.pipeline;
+  GstClockTime running_time;
+  GstClock *clock;
+
+  if (!GST_CLOCK_TIME_IS_VALID (pts))
+    return 0;
+
+  clock = gst_element_get_clock (pipeline);
+  if (!clock)
+    return 0;
+  running_time = gst_clock_get_time (clock) -
+      gst_element_get_base_time (pipeline);
+  gst_object_unref (clock);
+
+  /* Non live sources run ahead of or far behind the clock. */
+  if (running_time < pts || running_time - pts > GST_SECOND)
+    return 0;
+  return running_time - pts;
+}
+
+/**
+ * Stamp the frames of a batch passing a probe point, for the per stage
+ * latency breakdown.
+ */
+static void
+stamp_latency_stage (AppCtx * appCtx, NvDsBatchMeta * batch_meta,
+    NvDsLatencyStage stage, NvDsLatencyComponent component)
+{
+  if (!appCtx->latency_reporter || !batch_meta)
+    return;
+
+  for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
+      l_frame = l_frame->next) {
+    NvDsFrameMeta *frame_meta = (NvDsFrameMeta *) l_frame->data;
+    latency_reporter_stamp (appCtx->latency_reporter, frame_meta->source_id,
+        frame_meta->frame_num, stage, component);
+    if (stage == NV_DS_LATENCY_STAGE_PGIE) {
+      GstClockTime latency = get_frame_latency (appCtx, frame_meta->buf_pts);
+      if (latency)
+        latency_reporter_add (appCtx->latency_reporter,
+            frame_meta->source_id, NV_DS_LATENCY_PGIE,
+            (gdouble) latency / GST_MSECOND);
     }
+  }
+}
 
-    fclose (bbox_params_dump_file);
+/**
+ * Function to run target selection on every frame of the batch. Each stream
+ * of each instance follows its own target; consumers on other threads read
+ * the result with target_selector_read(). New results are also handed to
+ * every telemetry sender of the instance right away, stamped with the time
+ * the frame was captured so that the sender can compensate the latency.
+ */
+static void
+select_targets (AppCtx * appCtx, NvDsBatchMeta * batch_meta)
+{
+  for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
+      l_frame = l_frame->next) {
+    NvDsFrameMeta *frame_meta = l_frame->data;
+    NvDsTargetStream *stream =
+        target_selector_process_frame (&appCtx->target_selector, frame_meta);
+
+    if (stream && appCtx->num_telemetry_ctx) {
+      NvDsTelemetrySample sample;
+      guint i;
+      sample.stream_id = frame_meta->pad_index;
+      sample.frame_num = frame_meta->frame_num;
+      sample.pts = frame_meta->buf_pts;
+      sample.capture_time = g_get_monotonic_time () -
+          get_frame_latency (appCtx, frame_meta->buf_pts) / GST_USECOND;
+      sample.set = stream->published;
+      for (i = 0; i < appCtx->num_telemetry_ctx; i++)
+        telemetry_push (appCtx->telemetry_ctx[i], &sample);
+    }
   }
 }
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-static gint
-component_id_compare_func (gconstpointer a, gconstpointer b)
+/**
+ * Rank the configured GIEs for the display order of classifier labels.
+ */
+static void
+init_classifier_rank (AppCtx * appCtx)
 {
-  NvDsClassifierMeta *cmetaa = (NvDsClassifierMeta *) a;
-  NvDsClassifierMeta *cmetab = (NvDsClassifierMeta *) b;
-
-  if (cmetaa->unique_component_id < cmetab->unique_component_id)
-    return -1;
-  if (cmetaa->unique_component_id > cmetab->unique_component_id)
-    return 1;
-  return 0;
+  NvDsConfig *config = &appCtx->config;
+  guint ids[MAX_SECONDARY_GIE_BINS + 1];
+  guint num_ids = 0;
+
+  ids[num_ids++] = config->primary_gie_config.unique_id;
+  for (guint i = 0; i < config->num_secondary_gie_sub_bins; i++)
+    ids[num_ids++] = config->secondary_gie_sub_bin_config[i].unique_id;
+  classifier_rank_init (&appCtx->classifier_rank, ids, num_ids);
 }
 
 /**
@@ -429,63 +572,49 @@ component_id_compare_func (gconstpointer a, gconstpointer b)
 static void
 process_meta (AppCtx * appCtx, NvDsBatchMeta * batch_meta)
 {
+  gboolean draw_text;
+  gint show_source = -1;
+
   // For single source always display text either with demuxer or with tiler
   if (!appCtx->config.tiled_display_config.enable ||
       appCtx->config.num_source_sub_bins == 1) {
     appCtx->show_bbox_text = 1;
   }
 
+  /* Labels are only formatted for frames the OSD will draw text on. With
+   * the plain tiler expanded to one source, the others are not composited. */
+  draw_text = appCtx->show_bbox_text && appCtx->config.osd_config.enable
+      && appCtx->config.osd_config.draw_text;
+  if (appCtx->config.tiled_display_config.enable == NV_DS_TILED_DISPLAY_ENABLE)
+    show_source = g_atomic_int_get (&appCtx->show_source);
+
   for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
       l_frame = l_frame->next) {
     NvDsFrameMeta *frame_meta = l_frame->data;
+    gboolean frame_text = draw_text && (show_source < 0
+        || frame_meta->source_id == (guint) show_source);
     for (NvDsMetaList * l_obj = frame_meta->obj_meta_list; l_obj != NULL;
         l_obj = l_obj->next) {
       NvDsObjectMeta *obj = (NvDsObjectMeta *) l_obj->data;
-      gint class_index = obj->class_id;
-      NvDsGieConfig *gie_config = NULL;
-      gchar *str_ins_pos = NULL;
-
-      if (obj->unique_component_id ==
-          (gint) appCtx->config.primary_gie_config.unique_id) {
-        gie_config = &appCtx->config.primary_gie_config;
-      } else {
-        for (gint i = 0; i < (gint) appCtx->config.num_secondary_gie_sub_bins;
-            i++) {
-          gie_config = &appCtx->config.secondary_gie_sub_bin_config[i];
-          if (obj->unique_component_id == (gint) gie_config->unique_id) {
-            break;
-          }
-          gie_config = NULL;
-        }
-      }
+      const NvDsBboxStyle *style;
+      NvDsClassifierMeta *classifiers[MAX_OBJECT_CLASSIFIERS];
+      guint num_classifiers;
+      NvDsText text;
+
       g_free (obj->text_params.display_text);
       obj->text_params.display_text = NULL;
 
-      if (gie_config != NULL) {
-        if (g_hash_table_contains (gie_config->bbox_border_color_table,
-                class_index + (gchar *) NULL)) {
-          obj->rect_params.border_color =
-              *((NvOSD_ColorParams *)
-              g_hash_table_lookup (gie_config->bbox_border_color_table,
-                  class_index + (gchar *) NULL));
-        } else {
-          obj->rect_params.border_color = gie_config->bbox_border_color;
-        }
+      style = bbox_style_lookup (&appCtx->bbox_styles,
+          obj->unique_component_id, obj->class_id);
+      if (style != NULL) {
+        obj->rect_params.border_color = style->border_color;
         obj->rect_params.border_width = appCtx->config.osd_config.border_width;
-
-        if (g_hash_table_contains (gie_config->bbox_bg_color_table,
-                class_index + (gchar *) NULL)) {
-          obj->rect_params.has_bg_color = 1;
-          obj->rect_params.bg_color =
-              *((NvOSD_ColorParams *)
-              g_hash_table_lookup (gie_config->bbox_bg_color_table,
-                  class_index + (gchar *) NULL));
-        } else {
-          obj->rect_params.has_bg_color = 0;
-        }
+        obj->rect_params.has_bg_color = style->has_bg_color;
+        if (style->has_bg_color)
+          obj->rect_params.bg_color = style->bg_color;
       }
 
-      if (!appCtx->show_bbox_text)
+      if (!frame_text)
         continue;
 
       obj->text_params.x_offset = obj->rect_params.left;
@@ -500,40 +629,33 @@ process_meta (AppCtx * appCtx, NvDsBatchMeta * batch_meta)
         obj->text_params.text_bg_clr = appCtx->config.osd_config.text_bg_color;
       }
 
-      obj->text_params.display_text = g_malloc (128);
-      obj->text_params.display_text[0] = '\0';
-      str_ins_pos = obj->text_params.display_text;
+      text_begin (&text);
 
       if (obj->obj_label[0] != '\0')
-        sprintf (str_ins_pos, "%s", obj->obj_label);
-      str_ins_pos += strlen (str_ins_pos);
+        text_append (&text, "%s", obj->obj_label);
 
       if (obj->object_id != UNTRACKED_OBJECT_ID) {
         /** object_id is a 64-bit sequential value;
          * but considering the display aesthetic,
          * trimming to lower 32-bits */
         guint64 const LOW_32_MASK = 0x00000000FFFFFFFF;
-        sprintf (str_ins_pos, " %lu", (obj->object_id & LOW_32_MASK));
-        str_ins_pos += strlen (str_ins_pos);
+        text_append (&text, " %lu", (obj->object_id & LOW_32_MASK));
       }
 
-      obj->classifier_meta_list =
-          g_list_sort (obj->classifier_meta_list, component_id_compare_func);
-      for (NvDsMetaList * l_class = obj->classifier_meta_list; l_class != NULL;
-          l_class = l_class->next) {
-        NvDsClassifierMeta *cmeta = (NvDsClassifierMeta *) l_class->data;
-        for (NvDsMetaList * l_label = cmeta->label_info_list; l_label != NULL;
-            l_label = l_label->next) {
+      num_classifiers = classifier_rank_order (&appCtx->classifier_rank, obj,
+          classifiers);
+      for (guint i = 0; i < num_classifiers; i++) {
+        for (NvDsMetaList * l_label = classifiers[i]->label_info_list;
+            l_label != NULL; l_label = l_label->next) {
           NvDsLabelInfo *label = (NvDsLabelInfo *) l_label->data;
           if (label->pResult_label) {
-            sprintf (str_ins_pos, " %s", label->pResult_label);
+            text_append (&text, " %s", label->pResult_label);
           } else if (label->result_label[0] != '\0') {
-            sprintf (str_ins_pos, " %s", label->result_label);
+            text_append (&text, " %s", label->result_label);
           }
-          str_ins_pos += strlen (str_ins_pos);
         }
-
       }
+      obj->text_params.display_text = text_end (&text);
     }
   }
 }
@@ -573,6 +695,31 @@ process_buffer (GstBuffer * buf, AppCtx * appCtx, guint index)
   }
 }
 
+/**
+ * Function to hand a frame the primary GIE skipped to the ROI GIE, as a
+ * window around the followed target of its stream. The target was
+ * published downstream for an earlier frame and is predicted forward.
+ */
+static void
+attach_roi_window (AppCtx * appCtx, NvDsBatchMeta * batch_meta,
+    NvDsFrameMeta * frame_meta)
+{
+  NvDsTargetSelector *selector = &appCtx->target_selector;
+  NvDsTargetSet set;
+  NvDsRoiWindow window;
+
+  if (!target_selector_read (selector, frame_meta->pad_index, &set) ||
+      !roi_window_compute (&appCtx->config.roi_config, &set,
+          frame_meta->buf_pts, selector->frame_width, selector->frame_height,
+          &window))
+    return;
+
+  roi_window_attach (&appCtx->config.roi_config, batch_meta, frame_meta,
+      &window);
+  frame_counts_add (frame_counts_source (appCtx->frame_counts,
+          frame_meta->source_id), NV_DS_FRAMES_ROI, 1);
+}
+
 /**
  * Buffer probe function to get the results of primary infer.
  * Here it demonstrates the use by dumping bounding box coordinates in
@@ -590,11 +737,43 @@ gie_primary_processing_done_buf_prob (GstPad * pad, GstPadProbeInfo * info,
     return GST_PAD_PROBE_OK;
   }
 
+  stamp_latency_stage (appCtx, batch_meta, NV_DS_LATENCY_STAGE_PGIE,
+      NV_DS_LATENCY_PGIE);
+  for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
+      l_frame = l_frame->next) {
+    NvDsFrameMeta *frame_meta = l_frame->data;
+    if (frame_meta->bInferDone)
+      frame_counts_add (frame_counts_source (appCtx->frame_counts,
+              frame_meta->source_id), NV_DS_FRAMES_INFERRED, 1);
+    else if (appCtx->pipeline.common_elements.roi_gie)
+      attach_roi_window (appCtx, batch_meta, frame_meta);
+  }
   write_kitti_output (appCtx, batch_meta);
 
   return GST_PAD_PROBE_OK;
 }
 
+/**
+ * Buffer probe function after the ROI GIE, removing the windows it ran on
+ * before the tracker sees them.
+ */
+static GstPadProbeReturn
+roi_gie_done_buf_prob (GstPad * pad, GstPadProbeInfo * info, gpointer u_data)
+{
+  GstBuffer *buf = (GstBuffer *) info->data;
+  AppCtx *appCtx = (AppCtx *) u_data;
+  NvDsBatchMeta *batch_meta = gst_buffer_get_nvds_batch_meta (buf);
+  if (!batch_meta) {
+    NVGSTDS_WARN_MSG_V ("Batch meta not found for buffer %p", buf);
+    return GST_PAD_PROBE_OK;
+  }
+
+  for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
+      l_frame = l_frame->next)
+    roi_window_remove (&appCtx->config.roi_config, l_frame->data);
+  return GST_PAD_PROBE_OK;
+}
+
 /**
  * Probe function to get results after all inferences(Primary + Secondary)
  * are done. This will be just before OSD or sink (in case OSD is disabled).
@@ -608,11 +787,28 @@ gie_processing_done_buf_prob (GstPad * pad, GstPadProbeInfo * info,
   guint index = bin->index;
   AppCtx *appCtx = bin->appCtx;
 
+  if (appCtx->config.osd_config.enable)
+    stamp_latency_stage (appCtx, gst_buffer_get_nvds_batch_meta (buf),
+        NV_DS_LATENCY_STAGE_OSD, NV_DS_LATENCY_OSD_IN);
   if (gst_buffer_is_writable (buf))
     process_buffer (buf, appCtx, index);
   return GST_PAD_PROBE_OK;
 }
 
+/**
+ * Buffer probe function on the tiler input, for the per stage latency.
+ */
+static GstPadProbeReturn
+tiler_sink_buf_prob (GstPad * pad, GstPadProbeInfo * info, gpointer u_data)
+{
+  AppCtx *appCtx = (AppCtx *) u_data;
+  GstBuffer *buf = (GstBuffer *) info->data;
+
+  stamp_latency_stage (appCtx, gst_buffer_get_nvds_batch_meta (buf),
+      NV_DS_LATENCY_STAGE_TILER, NV_DS_LATENCY_TILER_IN);
+  return GST_PAD_PROBE_OK;
+}
+
 /**
  * Buffer probe function after tracker.
  */
@@ -630,11 +826,18 @@ analytics_done_buf_prob (GstPad * pad, GstPadProbeInfo * info, gpointer u_data)
     return GST_PAD_PROBE_OK;
   }
 
+  stamp_latency_stage (appCtx, batch_meta, NV_DS_LATENCY_STAGE_ANALYTICS,
+      NV_DS_LATENCY_ANALYTICS);
+  select_targets (appCtx, batch_meta);
+
   /*
    * Output KITTI labels with tracking ID if configured to do so.
    */
-
-  write_kitti_track_output(appCtx, batch_meta);
+  write_kitti_track_output (appCtx, batch_meta);
+  if (appCtx->config.tracker_config.enable_past_frame)
+  {
+    write_kitti_past_track_output (appCtx, batch_meta);
+  }
 
   if (appCtx->bbox_generated_post_analytics_cb)
   {
@@ -643,29 +846,92 @@ analytics_done_buf_prob (GstPad * pad, GstPadProbeInfo * info, gpointer u_data)
   return GST_PAD_PROBE_OK;
 }
 
+/**
+ * Probe on a sink pad of the muxer, counting the frames of one source.
+ */
+static GstPadProbeReturn
+source_frame_buf_prob (GstPad * pad, GstPadProbeInfo * info, gpointer u_data)
+{
+  frame_counts_add ((NvDsSourceFrameCounts *) u_data, NV_DS_FRAMES_DECODED,
+      1);
+  return GST_PAD_PROBE_OK;
+}
+
+/**
+ * Probe on the source pad of the muxer, counting the frames of each source
+ * that made it into a batch.
+ */
+static GstPadProbeReturn
+mux_frame_buf_prob (GstPad * pad, GstPadProbeInfo * info, gpointer u_data)
+{
+  AppCtx *appCtx = (AppCtx *) u_data;
+  NvDsBatchMeta *batch_meta =
+      gst_buffer_get_nvds_batch_meta ((GstBuffer *) info->data);
+
+  if (!batch_meta)
+    return GST_PAD_PROBE_OK;
+
+  for (NvDsMetaList * l_frame = batch_meta->frame_meta_list; l_frame != NULL;
+      l_frame = l_frame->next) {
+    NvDsFrameMeta *frame_meta = l_frame->data;
+    frame_counts_add (frame_counts_source (appCtx->frame_counts,
+            frame_meta->source_id), NV_DS_FRAMES_MUXED, 1);
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+/** Scratch of nvds_measure_buffer_latency(), one per streaming thread. */
+typedef struct
+{
+  guint capacity;
+  NvDsFrameLatencyInfo info[];
+} NvDsLatencyScratch;
+
+static GPrivate latency_scratch = G_PRIVATE_INIT (g_free);
+
+/**
+ * Record the end to end latency of each frame of a batch. The scratch is
+ * sized from the batch itself, not the muxer batch-size, and is private to
+ * the calling thread, so neither a lock nor a per pipeline allocation is
+ * needed and sources added at runtime are measured like the others.
+ */
+static void
+measure_frame_latency (AppCtx * appCtx, GstBuffer * buf, guint component)
+{
+  NvDsBatchMeta *batch_meta = gst_buffer_get_nvds_batch_meta (buf);
+  NvDsLatencyScratch *scratch = g_private_get (&latency_scratch);
+  guint i, num_sources_in_batch;
+
+  if (!batch_meta)
+    return;
+
+  if (!scratch || scratch->capacity < batch_meta->num_frames_in_batch) {
+    guint capacity = MAX (batch_meta->num_frames_in_batch,
+        scratch ? scratch->capacity * 2 : 1);
+
+    scratch = g_realloc (scratch, sizeof (NvDsLatencyScratch) +
+        capacity * sizeof (NvDsFrameLatencyInfo));
+    scratch->capacity = capacity;
+    g_private_set (&latency_scratch, scratch);
+  }
+
+  num_sources_in_batch = nvds_measure_buffer_latency (buf, scratch->info);
+  for (i = 0; i < num_sources_in_batch; i++) {
+    latency_reporter_add (appCtx->latency_reporter,
+        scratch->info[i].source_id, component, scratch->info[i].latency);
+  }
+}
+
 static GstPadProbeReturn
 latency_measurement_buf_prob(GstPad * pad, GstPadProbeInfo * info, gpointer u_data)
 {
   AppCtx *appCtx = (AppCtx *) u_data;
-  guint i = 0, num_sources_in_batch = 0;
   if(nvds_enable_latency_measurement)
   {
     GstBuffer *buf = (GstBuffer *) info->data;
-    NvDsFrameLatencyInfo *latency_info = NULL;
-    g_mutex_lock (&appCtx->latency_lock);
-    latency_info = appCtx->latency_info;
-    g_print("\n************BATCH-NUM = %d**************\n",batch_num);
-    num_sources_in_batch = nvds_measure_buffer_latency(buf, latency_info);
-
-    for(i = 0; i < num_sources_in_batch; i++)
-    {
-      g_print("Source id = %d Frame_num = %d Frame latency = %lf (ms) \n",
-          latency_info[i].source_id,
-          latency_info[i].frame_num,
-          latency_info[i].latency);
-    }
-    g_mutex_unlock (&appCtx->latency_lock);
-    batch_num++;
+    stamp_latency_stage (appCtx, gst_buffer_get_nvds_batch_meta (buf),
+        NV_DS_LATENCY_STAGE_SINK, NV_DS_LATENCY_SINK_IN);
+    measure_frame_latency (appCtx, buf, NV_DS_LATENCY_FRAME);
   }
 
   return GST_PAD_PROBE_OK;
@@ -675,25 +941,12 @@ static GstPadProbeReturn
 demux_latency_measurement_buf_prob(GstPad * pad, GstPadProbeInfo * info, gpointer u_data)
 {
   AppCtx *appCtx = (AppCtx *) u_data;
-  guint i = 0, num_sources_in_batch = 0;
   if(nvds_enable_latency_measurement)
   {
     GstBuffer *buf = (GstBuffer *) info->data;
-    NvDsFrameLatencyInfo *latency_info = NULL;
-    g_mutex_lock (&appCtx->latency_lock);
-    latency_info = appCtx->latency_info;
-    g_print("\n************DEMUX BATCH-NUM = %d**************\n",demux_batch_num);
-    num_sources_in_batch = nvds_measure_buffer_latency(buf, latency_info);
-
-    for(i = 0; i < num_sources_in_batch; i++)
-    {
-      g_print("Source id = %d Frame_num = %d Frame latency = %lf (ms) \n",
-          latency_info[i].source_id,
-          latency_info[i].frame_num,
-          latency_info[i].latency);
-    }
-    g_mutex_unlock (&appCtx->latency_lock);
-    demux_batch_num++;
+    stamp_latency_stage (appCtx, gst_buffer_get_nvds_batch_meta (buf),
+        NV_DS_LATENCY_STAGE_SINK, NV_DS_LATENCY_SINK_IN);
+    measure_frame_latency (appCtx, buf, NV_DS_LATENCY_DEMUX_FRAME);
   }
 
   return GST_PAD_PROBE_OK;
@@ -908,6 +1161,29 @@ create_common_elements (NvDsConfig * config, NvDsPipeline * pipeline,
     *sink_elem = pipeline->common_elements.tracker_bin.bin;
   }
 
+  if (config->primary_gie_config.enable &&
+      config->roi_config.config_file_path) {
+    roi_config_init (&config->roi_config);
+    pipeline->common_elements.roi_gie =
+        roi_gie_new (&config->roi_config, &config->primary_gie_config);
+    if (!pipeline->common_elements.roi_gie) {
+      goto done;
+    }
+    gst_bin_add (GST_BIN (pipeline->pipeline),
+        pipeline->common_elements.roi_gie);
+    if (!*src_elem) {
+      *src_elem = pipeline->common_elements.roi_gie;
+    }
+    if (*sink_elem) {
+      NVGSTDS_LINK_ELEMENT (pipeline->common_elements.roi_gie, *sink_elem);
+    }
+    *sink_elem = pipeline->common_elements.roi_gie;
+    NVGSTDS_ELEM_ADD_PROBE (pipeline->common_elements.roi_probe_id,
+        pipeline->common_elements.roi_gie, "src",
+        roi_gie_done_buf_prob, GST_PAD_PROBE_TYPE_BUFFER,
+        pipeline->common_elements.appCtx);
+  }
+
   if (config->primary_gie_config.enable) {
     if (!create_primary_gie_bin (&config->primary_gie_config,
             &pipeline->common_elements.primary_gie_bin)) {
@@ -1069,11 +1345,78 @@ create_pipeline (AppCtx * appCtx,
     set_streammux_properties (&config->streammux_config,
         pipeline->multi_src_bin.streammux);
 
-  if(appCtx->latency_info == NULL)
-  {
-    appCtx->latency_info = (NvDsFrameLatencyInfo *)
-      calloc(1, config->streammux_config.batch_size *
-          sizeof(NvDsFrameLatencyInfo));
+  appCtx->frame_counts = frame_counts_new ();
+  if (!appCtx->frame_counts)
+    goto done;
+  for (i = 0; i < pipeline->multi_src_bin.num_bins; i++) {
+    gchar pad_name[16];
+
+    g_snprintf (pad_name, sizeof (pad_name), "sink_%u", i);
+    NVGSTDS_ELEM_ADD_PROBE (appCtx->source_frame_probe_ids[i],
+        pipeline->multi_src_bin.streammux, pad_name, source_frame_buf_prob,
+        GST_PAD_PROBE_TYPE_BUFFER,
+        frame_counts_source (appCtx->frame_counts, i));
+  }
+  NVGSTDS_ELEM_ADD_PROBE (appCtx->mux_frame_probe_id,
+      pipeline->multi_src_bin.streammux, "src", mux_frame_buf_prob,
+      GST_PAD_PROBE_TYPE_BUFFER, appCtx);
+
+  if (config->bbox_dir_path || config->kitti_track_dir_path) {
+    appCtx->kitti_writer = kitti_writer_new (config->kitti_output_sync);
+    if (!appCtx->kitti_writer)
+      goto done;
+  }
+
+  if (config->kitti_output_format == NV_DS_KITTI_OUTPUT_DETLOG) {
+    if (config->bbox_dir_path) {
+      gchar *path = g_strdup_printf ("%s/%02u_gie.ndl",
+          config->bbox_dir_path, appCtx->index);
+      appCtx->gie_log = detlog_open (appCtx->kitti_writer, KITTI_WRITER_GIE,
+          path, appCtx->index);
+      g_free (path);
+      if (!appCtx->gie_log)
+        goto done;
+    }
+    if (config->kitti_track_dir_path) {
+      gchar *path = g_strdup_printf ("%s/%02u_track.ndl",
+          config->kitti_track_dir_path, appCtx->index);
+      appCtx->track_log = detlog_open (appCtx->kitti_writer,
+          KITTI_WRITER_TRACK, path, appCtx->index);
+      g_free (path);
+      if (!appCtx->track_log)
+        goto done;
+    }
+  }
+
+  appCtx->show_source = -1;
+  init_classifier_rank (appCtx);
+  appCtx->stats = app_stats_new (config->num_source_sub_bins);
+  if (config->count_shm_name) {
+    gchar *name = g_strdup_printf ("/%s_%02u", config->count_shm_name,
+        appCtx->index);
+    appCtx->count_shm = count_shm_open (name, config->num_source_sub_bins,
+        config->count_shm_frames, appCtx->index);
+    g_free (name);
+    if (!appCtx->count_shm)
+      goto done;
+  }
+  bbox_style_table_init (&appCtx->bbox_styles, &config->primary_gie_config,
+      config->secondary_gie_sub_bin_config, config->num_secondary_gie_sub_bins);
+
+  target_selector_init (&appCtx->target_selector,
+      config->streammux_config.pipeline_width,
+      config->streammux_config.pipeline_height, config->target_gate_radius,
+      &config->target_class_filter, config->target_max_coast_ms);
+
+  /* Kept by the application context, so a re-created pipeline continues the
+   * histograms of the previous one. */
+  if (nvds_enable_latency_measurement && !appCtx->latency_reporter) {
+    appCtx->latency_reporter =
+        latency_reporter_new (MAX_SOURCE_BINS, latency_component_names,
+        NV_DS_LATENCY_NUM_COMPONENTS,
+        config->perf_measurement_interval_sec ?
+        config->perf_measurement_interval_sec : LATENCY_DEFAULT_REPORT_SEC,
+        appCtx->index);
   }
 
   /** a tee after the tiler which shall be connected to sink(s) */
@@ -1183,6 +1526,12 @@ create_pipeline (AppCtx * appCtx,
     NVGSTDS_LINK_ELEMENT (pipeline->tiled_display_bin.bin, last_elem);
     last_elem = pipeline->tiled_display_bin.bin;
 
+    if (appCtx->latency_reporter) {
+      NVGSTDS_ELEM_ADD_PROBE (latency_probe_id,
+          pipeline->tiled_display_bin.bin, "sink",
+          tiler_sink_buf_prob, GST_PAD_PROBE_TYPE_BUFFER, appCtx);
+    }
+
     link_element_to_tee_src_pad (pipeline->tiler_tee, pipeline->tiled_display_bin.bin);
     last_elem = pipeline->tiler_tee;
 
@@ -1294,11 +1643,45 @@ create_pipeline (AppCtx * appCtx,
   }
   //gst_object_unref (fps_pad);
 
-  NVGSTDS_ELEM_ADD_PROBE (latency_probe_id,
-      pipeline->instance_bins->sink_bin.sub_bins[0].sink, "sink",
-      latency_measurement_buf_prob, GST_PAD_PROBE_TYPE_BUFFER,
-      appCtx);
-  latency_probe_id = latency_probe_id;
+  if (config->primary_gie_config.enable &&
+      interval_ctl_enabled (&config->interval_ctl_config)) {
+    /* A target whose input is not measured would never be met, so the
+     * interval could only grow. */
+    NvDsIntervalCtlConfig ctl_config = config->interval_ctl_config;
+    if (ctl_config.target_latency_ms && !appCtx->latency_reporter) {
+      NVGSTDS_WARN_MSG_V ("Adaptive interval latency target needs "
+          "NVDS_ENABLE_LATENCY_MEASUREMENT=1, ignoring it");
+      ctl_config.target_latency_ms = 0;
+    }
+    if (ctl_config.target_fps > 0 && !config->enable_perf_measurement) {
+      NVGSTDS_WARN_MSG_V ("Adaptive interval fps target needs "
+          "enable-perf-measurement=1, ignoring it");
+      ctl_config.target_fps = 0;
+    }
+    if (interval_ctl_enabled (&ctl_config)) {
+      interval_ctl_init (&appCtx->interval_ctl, &ctl_config,
+          config->primary_gie_config.interval);
+      appCtx->interval_ctl_timer =
+          g_timeout_add (appCtx->interval_ctl.config.period_ms,
+          adapt_pgie_interval, appCtx);
+    }
+  }
+
+  if (pipeline->common_elements.roi_gie) {
+    if (!config->primary_gie_config.interval && !appCtx->interval_ctl_timer)
+      NVGSTDS_WARN_MSG_V ("ROI GIE only runs on frames the primary GIE "
+          "skips; set an interval on the primary GIE");
+    for (i = 0; i < config->num_secondary_gie_sub_bins; i++) {
+      if (config->secondary_gie_sub_bin_config[i].unique_id ==
+          config->roi_config.component_id)
+        NVGSTDS_WARN_MSG_V ("roi-component-id %d is also the unique id of "
+            "a secondary GIE", config->roi_config.component_id);
+    }
+    if (config->primary_gie_config.unique_id ==
+        config->roi_config.component_id)
+      NVGSTDS_WARN_MSG_V ("roi-component-id %d is also the unique id of "
+          "the primary GIE", config->roi_config.component_id);
+  }
 
   if (config->num_message_consumers) {
     for (i = 0; i < config->num_message_consumers; i++) {
@@ -1316,7 +1699,6 @@ create_pipeline (AppCtx * appCtx,
 
   g_mutex_init (&appCtx->app_lock);
   g_cond_init (&appCtx->app_cond);
-  g_mutex_init (&appCtx->latency_lock);
 
   ret = TRUE;
 done:
@@ -1342,6 +1724,11 @@ destroy_pipeline (AppCtx * appCtx)
   if (!appCtx)
     return;
 
+  if (appCtx->interval_ctl_timer) {
+    g_source_remove (appCtx->interval_ctl_timer);
+    appCtx->interval_ctl_timer = 0;
+  }
+
   if (appCtx->pipeline.demuxer) {
     gst_pad_send_event (gst_element_get_static_pad (appCtx->pipeline.demuxer,
             "sink"), gst_event_new_eos ());
@@ -1388,14 +1775,33 @@ destroy_pipeline (AppCtx * appCtx)
     }
 
   }
-  if(appCtx->latency_info == NULL)
-  {
-    free(appCtx->latency_info);
-    appCtx->latency_info = NULL;
+
+  if (appCtx->pipeline.common_elements.roi_gie) {
+    NVGSTDS_ELEM_REMOVE_PROBE (appCtx->pipeline.common_elements.roi_probe_id,
+        appCtx->pipeline.common_elements.roi_gie, "src");
   }
 
   destroy_sink_bin ();
-  g_mutex_clear(&appCtx->latency_lock);
+  target_selector_destroy (&appCtx->target_selector);
+  detlog_close (appCtx->gie_log);
+  detlog_close (appCtx->track_log);
+  appCtx->gie_log = NULL;
+  appCtx->track_log = NULL;
+  kitti_writer_free (appCtx->kitti_writer);
+  appCtx->kitti_writer = NULL;
+  if (appCtx->frame_counts) {
+    for (i = 0; i < appCtx->pipeline.multi_src_bin.num_bins; i++) {
+      gchar pad_name[16];
+
+      g_snprintf (pad_name, sizeof (pad_name), "sink_%u", i);
+      NVGSTDS_ELEM_REMOVE_PROBE (appCtx->source_frame_probe_ids[i],
+          appCtx->pipeline.multi_src_bin.streammux, pad_name);
+    }
+    NVGSTDS_ELEM_REMOVE_PROBE (appCtx->mux_frame_probe_id,
+        appCtx->pipeline.multi_src_bin.streammux, "src");
+  }
+  frame_counts_free (appCtx->frame_counts);
+  appCtx->frame_counts = NULL;
 
   if (appCtx->pipeline.pipeline) {
     bus = gst_pipeline_get_bus (GST_PIPELINE (appCtx->pipeline.pipeline));
@@ -1403,6 +1809,11 @@ destroy_pipeline (AppCtx * appCtx)
     gst_object_unref (bus);
     gst_object_unref (appCtx->pipeline.pipeline);
   }
+  bbox_style_table_deinit (&appCtx->bbox_styles);
+  app_stats_free (appCtx->stats);
+  appCtx->stats = NULL;
+  count_shm_close (appCtx->count_shm);
+  appCtx->count_shm = NULL;
 
   if (config->num_message_consumers) {
     for (i = 0; i < config->num_message_consumers; i++) {
@@ -45,40 +45,66 @@ extern "C"
 #include "deepstream_tracker.h"
 #include "deepstream_secondary_gie.h"
 #include "deepstream_c2d_msg.h"
+#include "deepstream_app_target.h"
+#include "deepstream_app_telemetry.h"
+#include "deepstream_app_kitti_writer.h"
+#include "deepstream_app_text.h"
+#include "deepstream_app_classifier_rank.h"
+#include "deepstream_app_bbox_style.h"
+#include "deepstream_app_stats.h"
+#include "deepstream_app_count_shm.h"
+#include "deepstream_app_latency.h"
+#include "deepstream_app_metrics.h"
+#include "deepstream_app_perf_slot.h"
+#include "deepstream_app_frame_counts.h"
+#include "deepstream_app_interval_ctl.h"
+#include "deepstream_app_roi.h"
+#include "deepstream_app_detlog.h"
 
 
 typedef struct _AppCtx AppCtx;
 
-typedef void (*bbox_generated_callback) (AppCtx *appCtx, GstBuffer *buf,
-    NvDsBatchMeta *batch_meta, guint index);
-typedef gboolean (*overlay_graphics_callback) (AppCtx *appCtx, GstBuffer *buf,
-    NvDsBatchMeta *batch_meta, guint index);
-
-//////////////////////////////////////////////////////////////////////////////
-struct track_buf
+/** Latencies reported per stream. */
+typedef enum
 {
-	float centerx;
-	float centery;
-	float width;
-	float height;
-	float score;
-	int fframe;
-	char *label;
-	int idx;
-	char flag;
-};
+  /** End to end, at the sink of the tiled or single stream output. */
+  NV_DS_LATENCY_FRAME,
+  /** End to end, at the sinks of the demuxed per stream outputs. */
+  NV_DS_LATENCY_DEMUX_FRAME,
+  /** Capture to primary GIE output, live sources only. */
+  NV_DS_LATENCY_PGIE,
+  /** Stage latencies, from the previous stage the frame was stamped at to
+   * the output of the tracker and secondary GIEs, */
+  NV_DS_LATENCY_ANALYTICS,
+  /** the tiler input, */
+  NV_DS_LATENCY_TILER_IN,
+  /** the OSD input, */
+  NV_DS_LATENCY_OSD_IN,
+  /** the sink. */
+  NV_DS_LATENCY_SINK_IN,
+  NV_DS_LATENCY_NUM_COMPONENTS
+} NvDsLatencyComponent;
 
-typedef struct
+/** Names of the NvDsLatencyComponent values in reports and metrics. */
+extern const gchar *latency_component_names[NV_DS_LATENCY_NUM_COMPONENTS];
+
+/** Probe points frames are stamped at, in pipeline order. */
+typedef enum
 {
-	float centerx;
-	float centery;
-	float width;
-	float height;
-	char detect_flag;
-	int reset_flag;
-}tracked_data;
+  NV_DS_LATENCY_STAGE_PGIE,
+  NV_DS_LATENCY_STAGE_ANALYTICS,
+  NV_DS_LATENCY_STAGE_TILER,
+  NV_DS_LATENCY_STAGE_OSD,
+  NV_DS_LATENCY_STAGE_SINK
+} NvDsLatencyStage;
+
+/** Latency report period when perf-measurement-interval-sec is not set. */
+#define LATENCY_DEFAULT_REPORT_SEC 5
 
-//////////////////////////////////////////////////////////////////////////////
+typedef void (*bbox_generated_callback) (AppCtx *appCtx, GstBuffer *buf,
+    NvDsBatchMeta *batch_meta, guint index);
+typedef gboolean (*overlay_graphics_callback) (AppCtx *appCtx, GstBuffer *buf,
+    NvDsBatchMeta *batch_meta, guint index);
 
 typedef struct
 {
@@ -93,6 +119,9 @@ typedef struct
   NvDsOSDBin osd_bin;
   NvDsSecondaryGieBin secondary_gie_bin;
   NvDsTrackerBin tracker_bin;
+  /** Detector run on the frames the primary GIE skips, NULL if none. */
+  GstElement *roi_gie;
+  gulong roi_probe_id;
   NvDsSinkBin sink_bin;
   NvDsSinkBin demux_sink_bin;
   NvDsDsExampleBin dsexample_bin;
@@ -115,6 +144,14 @@ typedef struct
   AppCtx *appCtx;
 } NvDsPipeline;
 
+typedef enum
+{
+  /** One KITTI text file per stream and frame. */
+  NV_DS_KITTI_OUTPUT_TEXT,
+  /** One columnar detection log per output directory and instance. */
+  NV_DS_KITTI_OUTPUT_DETLOG,
+} NvDsKittiOutputFormat;
+
 typedef struct
 {
   gboolean enable_perf_measurement;
@@ -125,9 +162,23 @@ typedef struct
   guint num_secondary_gie_sub_bins;
   guint num_sink_sub_bins;
   guint num_message_consumers;
+  guint num_telemetry_destinations;
   guint perf_measurement_interval_sec;
   gchar *bbox_dir_path;
   gchar *kitti_track_dir_path;
+  gboolean kitti_output_sync;
+  NvDsKittiOutputFormat kitti_output_format;
+  gdouble target_gate_radius;
+  gchar **target_classes;
+  guint target_max_coast_ms;
+  /** Shared memory object of the per frame class counts, NULL if none. */
+  gchar *count_shm_name;
+  guint count_shm_frames;
+  /** Adaptive primary GIE interval, disabled without a target. */
+  NvDsIntervalCtlConfig interval_ctl_config;
+  /** Inference on a window around the followed target, disabled without a
+   * ROI GIE config file. */
+  NvDsRoiConfig roi_config;
 
   gchar **uri_list;
   NvDsSourceConfig multi_source_config[MAX_SOURCE_BINS];
@@ -141,6 +192,9 @@ typedef struct
   NvDsTiledDisplayConfig tiled_display_config;
   NvDsDsExampleConfig dsexample_config;
   NvDsSinkMsgConvBrokerConfig msg_conv_config;
+  NvDsTelemetryConfig telemetry_config[MAX_TELEMETRY_DESTINATIONS];
+  /** target_classes resolved against the primary GIE labels. */
+  NvDsClassFilter target_class_filter;
 } NvDsConfig;
 
 typedef struct
@@ -153,9 +207,10 @@ struct _AppCtx
   gboolean version;
   gboolean cintr;
   gboolean show_bbox_text;
+  /** Source shown by the tiler, -1 for all; mirrors its show-source. */
+  gint show_source;
   gboolean seeking;
   gboolean quit;
-  gint person_class_id;
   gint car_class_id;
   gint return_value;
   guint index;
@@ -169,11 +224,30 @@ struct _AppCtx
   NvDsInstanceData instance_data[MAX_SOURCE_BINS];
   NvDsC2DContext *c2d_ctx[MAX_MESSAGE_CONSUMERS];
   NvDsAppPerfStructInt perf_struct;
+  /** Last numbers of perf_struct, read by the perf table and metrics. */
+  NvDsPerfSlot perf_slot;
   bbox_generated_callback bbox_generated_post_analytics_cb;
   bbox_generated_callback all_bbox_generated_cb;
   overlay_graphics_callback overlay_graphics_cb;
-  NvDsFrameLatencyInfo *latency_info;
-  GMutex latency_lock;
+  /** Outlives the pipeline, freed with the application context. */
+  NvDsLatencyReporter *latency_reporter;
+  NvDsTargetSelector target_selector;
+  NvDsTelemetryCtx *telemetry_ctx[MAX_TELEMETRY_DESTINATIONS];
+  guint num_telemetry_ctx;
+  NvDsKittiWriter *kitti_writer;
+  NvDsDetLog *gie_log;
+  NvDsDetLog *track_log;
+  NvDsBboxStyleTable bbox_styles;
+  NvDsClassifierRank classifier_rank;
+  NvDsAppStats *stats;
+  NvDsCountShm *count_shm;
+  NvDsFrameCounts *frame_counts;
+  /** Probes feeding frame_counts, removed before it is freed. */
+  gulong source_frame_probe_ids[MAX_SOURCE_BINS];
+  gulong mux_frame_probe_id;
+  NvDsIntervalCtl interval_ctl;
+  /** Main loop source running interval_ctl, 0 if not adapting. */
+  guint interval_ctl_timer;
   GThread *ota_handler_thread;
   guint ota_inotify_fd;
   guint ota_watch_desc;
@@ -206,6 +280,14 @@ gboolean seek_pipeline (AppCtx * appCtx, glong milliseconds, gboolean seek_is_re
 
 void toggle_show_bbox_text (AppCtx * appCtx);
 
+/** Rank of a GIE in the display order of classifier labels. */
+static inline guint
+get_classifier_rank (AppCtx * appCtx, gint unique_component_id)
+{
+  return classifier_rank_lookup (&appCtx->classifier_rank,
+      unique_component_id);
+}
+
 void destroy_pipeline (AppCtx * appCtx);
 void restart_pipeline (AppCtx * appCtx);
 
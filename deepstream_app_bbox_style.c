@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_app_bbox_style.h"
+
+static guint
+color_table_num_classes (GHashTable * table)
+{
+  GHashTableIter iter;
+  gpointer key;
+  guint num_classes = 0;
+
+  if (!table)
+    return 0;
+
+  g_hash_table_iter_init (&iter, table);
+  while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    gint class_id = GPOINTER_TO_INT (key);
+    if (class_id >= 0 && (guint) class_id >= num_classes)
+      num_classes = class_id + 1;
+  }
+  return num_classes;
+}
+
+static void
+gie_bbox_styles_init (NvDsGieBboxStyles * gie, NvDsGieConfig * config)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+  guint i;
+
+  gie->gie_id = config->unique_id;
+  gie->default_style.border_color = config->bbox_border_color;
+  gie->default_style.has_bg_color = FALSE;
+  gie->num_classes =
+      MAX (color_table_num_classes (config->bbox_border_color_table),
+      color_table_num_classes (config->bbox_bg_color_table));
+  gie->classes = g_new (NvDsBboxStyle, gie->num_classes);
+  for (i = 0; i < gie->num_classes; i++)
+    gie->classes[i] = gie->default_style;
+
+  if (config->bbox_border_color_table) {
+    g_hash_table_iter_init (&iter, config->bbox_border_color_table);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+      gint class_id = GPOINTER_TO_INT (key);
+      if (class_id >= 0)
+        gie->classes[class_id].border_color = *(NvOSD_ColorParams *) value;
+    }
+  }
+  if (config->bbox_bg_color_table) {
+    g_hash_table_iter_init (&iter, config->bbox_bg_color_table);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+      gint class_id = GPOINTER_TO_INT (key);
+      if (class_id >= 0) {
+        gie->classes[class_id].bg_color = *(NvOSD_ColorParams *) value;
+        gie->classes[class_id].has_bg_color = TRUE;
+      }
+    }
+  }
+}
+
+static void
+bbox_style_table_add (NvDsBboxStyleTable * table, NvDsGieConfig * config)
+{
+  guint i;
+
+  for (i = 0; i < table->num_gies; i++) {
+    if (table->gies[i].gie_id == config->unique_id)
+      return;
+  }
+
+  gie_bbox_styles_init (&table->gies[table->num_gies], config);
+  table->num_gies++;
+  if (config->unique_id < BBOX_STYLE_MAX_DIRECT_IDS)
+    table->direct[config->unique_id] = table->num_gies;
+}
+
+void
+bbox_style_table_init (NvDsBboxStyleTable * table,
+    NvDsGieConfig * primary, NvDsGieConfig * secondary, guint num_secondary)
+{
+  guint i;
+
+  memset (table, 0, sizeof (*table));
+  table->gies = g_new0 (NvDsGieBboxStyles, num_secondary + 1);
+
+  bbox_style_table_add (table, primary);
+  for (i = 0; i < num_secondary; i++)
+    bbox_style_table_add (table, &secondary[i]);
+}
+
+void
+bbox_style_table_deinit (NvDsBboxStyleTable * table)
+{
+  guint i;
+
+  for (i = 0; i < table->num_gies; i++)
+    g_free (table->gies[i].classes);
+  g_free (table->gies);
+  memset (table, 0, sizeof (*table));
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_BBOX_STYLE_H__
+#define __NVGSTDS_APP_BBOX_STYLE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "deepstream_gie.h"
+
+/** GIE unique ids below this limit are resolved with a direct index. */
+#define BBOX_STYLE_MAX_DIRECT_IDS 256
+
+typedef struct
+{
+  NvOSD_ColorParams border_color;
+  NvOSD_ColorParams bg_color;
+  gboolean has_bg_color;
+} NvDsBboxStyle;
+
+/**
+ * Box colors of one GIE, flattened from its per class color tables. Class
+ * ids without an entry, including those past num_classes, use the default.
+ */
+typedef struct
+{
+  guint gie_id;
+  NvDsBboxStyle *classes;
+  guint num_classes;
+  NvDsBboxStyle default_style;
+} NvDsGieBboxStyles;
+
+typedef struct
+{
+  NvDsGieBboxStyles *gies;
+  guint num_gies;
+  /** Index + 1 into gies of each unique id, 0 if the id is not a GIE. */
+  guint8 direct[BBOX_STYLE_MAX_DIRECT_IDS];
+} NvDsBboxStyleTable;
+
+/**
+ * Resolve the box colors of the primary and secondary GIEs. A secondary
+ * GIE sharing the unique id of the primary one is shadowed by it, as is
+ * any GIE sharing the id of an earlier one.
+ */
+void bbox_style_table_init (NvDsBboxStyleTable * table,
+    NvDsGieConfig * primary, NvDsGieConfig * secondary, guint num_secondary);
+
+void bbox_style_table_deinit (NvDsBboxStyleTable * table);
+
+/** @return style of the class, NULL if @p gie_id is not a known GIE. */
+static inline const NvDsBboxStyle *
+bbox_style_lookup (NvDsBboxStyleTable * table, gint gie_id, gint class_id)
+{
+  NvDsGieBboxStyles *gie = NULL;
+  guint i;
+
+  if ((guint) gie_id < BBOX_STYLE_MAX_DIRECT_IDS) {
+    if (table->direct[gie_id])
+      gie = &table->gies[table->direct[gie_id] - 1];
+  } else {
+    for (i = 0; i < table->num_gies; i++) {
+      if (table->gies[i].gie_id == (guint) gie_id) {
+        gie = &table->gies[i];
+        break;
+      }
+    }
+  }
+  if (!gie)
+    return NULL;
+
+  if ((guint) class_id < gie->num_classes)
+    return &gie->classes[class_id];
+  return &gie->default_style;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
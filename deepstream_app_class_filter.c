@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "deepstream_common.h"
+#include "deepstream_app_class_filter.h"
+
+static NvDsClassMask *
+class_filter_get (NvDsClassFilter * filter, gint gie_id)
+{
+  NvDsClassMask *mask = class_filter_lookup (filter, gie_id);
+
+  if (mask || filter->num_gies == CLASS_FILTER_MAX_GIES)
+    return mask;
+
+  mask = &filter->gies[filter->num_gies++];
+  memset (mask, 0, sizeof (*mask));
+  mask->gie_id = gie_id;
+  return mask;
+}
+
+static gboolean
+class_filter_set (NvDsClassFilter * filter, gint gie_id, gint class_id)
+{
+  NvDsClassMask *mask;
+
+  if (class_id < 0 || class_id >= CLASS_FILTER_MAX_CLASSES) {
+    NVGSTDS_ERR_MSG_V ("Class id %d out of range, max %d", class_id,
+        CLASS_FILTER_MAX_CLASSES - 1);
+    return FALSE;
+  }
+
+  mask = class_filter_get (filter, gie_id);
+  if (!mask) {
+    NVGSTDS_ERR_MSG_V ("Classes of max %d GIEs can be selected",
+        CLASS_FILTER_MAX_GIES);
+    return FALSE;
+  }
+
+  mask->selected[class_id >> 6] |= 1ULL << (class_id & 63);
+  mask->known[class_id >> 6] |= 1ULL << (class_id & 63);
+  return TRUE;
+}
+
+/**
+ * Labels are separated by ';' (detector label files) or by new lines
+ * (classifier and most custom label files). Lines are split first so a
+ * CRLF line ending does not count as an extra, empty label.
+ */
+static gchar **
+class_filter_read_labels (const gchar * label_file_path)
+{
+  GPtrArray *labels;
+  gchar *contents = NULL;
+  gchar **lines;
+  guint i, j;
+
+  if (!label_file_path
+      || !g_file_get_contents (label_file_path, &contents, NULL, NULL))
+    return NULL;
+
+  labels = g_ptr_array_new ();
+  lines = g_strsplit (contents, "\n", -1);
+  for (i = 0; lines[i]; i++) {
+    gchar **names = g_strsplit (g_strstrip (lines[i]), ";", -1);
+
+    for (j = 0; names[j]; j++)
+      g_ptr_array_add (labels, g_strstrip (names[j]));
+    g_free (names);
+  }
+  g_ptr_array_add (labels, NULL);
+  g_strfreev (lines);
+  g_free (contents);
+  return (gchar **) g_ptr_array_free (labels, FALSE);
+}
+
+gboolean
+class_filter_init (NvDsClassFilter * filter, gchar ** entries, gint gie_id,
+    const gchar * label_file_path)
+{
+  GPtrArray *names = g_ptr_array_new_with_free_func (g_free);
+  gchar **labels = NULL;
+  gboolean ret = FALSE;
+  gchar **entry;
+
+  memset (filter, 0, sizeof (*filter));
+
+  for (entry = entries; entry && *entry; entry++) {
+    gchar *sep = strchr (*entry, ':');
+    gint class_id = -1;
+    guint i;
+
+    if (sep) {
+      gchar *end_gie, *end_class;
+      gint entry_gie = strtol (*entry, &end_gie, 10);
+      class_id = strtol (sep + 1, &end_class, 10);
+      if (end_gie != sep || sep[1] == '\0' || *end_class != '\0') {
+        NVGSTDS_ERR_MSG_V ("Invalid class '%s', expected "
+            "<gie-id>:<class-id>", *entry);
+        goto done;
+      }
+      if (!class_filter_set (filter, entry_gie, class_id))
+        goto done;
+      continue;
+    }
+
+    if (!labels)
+      labels = class_filter_read_labels (label_file_path);
+    for (i = 0; labels && labels[i]; i++) {
+      if (!strcmp (labels[i], *entry)) {
+        class_id = i;
+        break;
+      }
+    }
+
+    if (class_id >= 0) {
+      if (!class_filter_set (filter, gie_id, class_id))
+        goto done;
+    } else {
+      g_ptr_array_add (names, g_strdup (*entry));
+    }
+  }
+
+  if (names->len) {
+    g_ptr_array_add (names, NULL);
+    filter->names = (gchar **) g_ptr_array_free (names, FALSE);
+    names = NULL;
+  }
+  ret = TRUE;
+
+done:
+  if (names)
+    g_ptr_array_free (names, TRUE);
+  g_strfreev (labels);
+  return ret;
+}
+
+void
+class_filter_deinit (NvDsClassFilter * filter)
+{
+  g_strfreev (filter->names);
+  filter->names = NULL;
+}
+
+gboolean
+class_filter_learn (NvDsClassFilter * filter, NvDsObjectMeta * obj)
+{
+  NvDsClassMask *mask = class_filter_get (filter, obj->unique_component_id);
+  guint word = obj->class_id >> 6;
+  guint64 bit = 1ULL << (obj->class_id & 63);
+  gchar **name;
+
+  if (!mask)
+    return FALSE;
+
+  mask->known[word] |= bit;
+  for (name = filter->names; *name; name++) {
+    if (!strcmp (obj->obj_label, *name)) {
+      mask->selected[word] |= bit;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_CLASS_FILTER_H__
+#define __NVGSTDS_APP_CLASS_FILTER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "gstnvdsmeta.h"
+
+/** Class ids above this limit never match. */
+#define CLASS_FILTER_MAX_CLASSES 128
+#define CLASS_FILTER_WORDS (CLASS_FILTER_MAX_CLASSES / 64)
+/** Number of GIEs (unique_component_id) a filter can select classes of. */
+#define CLASS_FILTER_MAX_GIES 8
+
+typedef struct
+{
+  gint gie_id;
+  guint64 selected[CLASS_FILTER_WORDS];
+  /** Classes whose label was already compared against the names below. */
+  guint64 known[CLASS_FILTER_WORDS];
+} NvDsClassMask;
+
+/**
+ * Set of selected class ids per GIE. Class names are resolved to ids from
+ * the label file when the config is parsed; names that cannot be resolved
+ * there are matched against obj_label once per class id and cached, so the
+ * per object test stays a bit test.
+ */
+typedef struct
+{
+  NvDsClassMask gies[CLASS_FILTER_MAX_GIES];
+  guint num_gies;
+  /** Names still to be resolved from object labels, NULL if none. */
+  gchar **names;
+} NvDsClassFilter;
+
+/**
+ * Build the filter from config entries.
+ *
+ * @param[in] filter filter to fill.
+ * @param[in] entries NULL terminated list of "<gie-id>:<class-id>" or
+ *            class names of the default GIE.
+ * @param[in] gie_id unique id of the GIE class names refer to.
+ * @param[in] label_file_path label file of that GIE, may be NULL.
+ *
+ * @return FALSE if an entry is malformed or does not fit the filter.
+ */
+gboolean class_filter_init (NvDsClassFilter * filter, gchar ** entries,
+    gint gie_id, const gchar * label_file_path);
+
+void class_filter_deinit (NvDsClassFilter * filter);
+
+/** Slow path of class_filter_match() for classes not resolved yet. */
+gboolean class_filter_learn (NvDsClassFilter * filter, NvDsObjectMeta * obj);
+
+static inline NvDsClassMask *
+class_filter_lookup (NvDsClassFilter * filter, gint gie_id)
+{
+  guint i;
+
+  for (i = 0; i < filter->num_gies; i++) {
+    if (filter->gies[i].gie_id == gie_id)
+      return &filter->gies[i];
+  }
+  return NULL;
+}
+
+/**
+ * Check whether an object belongs to a selected class. Call from a single
+ * streaming thread per filter.
+ */
+static inline gboolean
+class_filter_match (NvDsClassFilter * filter, NvDsObjectMeta * obj)
+{
+  NvDsClassMask *mask;
+  guint word, class_id = obj->class_id;
+  guint64 bit;
+
+  if (class_id >= CLASS_FILTER_MAX_CLASSES)
+    return FALSE;
+
+  word = class_id >> 6;
+  bit = 1ULL << (class_id & 63);
+  mask = class_filter_lookup (filter, obj->unique_component_id);
+  if (G_LIKELY (!filter->names || (mask && (mask->known[word] & bit))))
+    return mask && (mask->selected[word] & bit);
+
+  return class_filter_learn (filter, obj);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
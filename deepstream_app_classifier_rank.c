@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_app_classifier_rank.h"
+
+void
+classifier_rank_init (NvDsClassifierRank * rank, const guint * ids,
+    guint num_ids)
+{
+  gboolean present[CLASSIFIER_RANK_MAX_IDS] = { FALSE };
+  guint next = 0, i;
+
+  memset (rank->ranks, CLASSIFIER_RANK_UNKNOWN, sizeof (rank->ranks));
+
+  for (i = 0; i < num_ids; i++) {
+    if (ids[i] < CLASSIFIER_RANK_MAX_IDS)
+      present[ids[i]] = TRUE;
+  }
+  /* Walking the direct index visits the ids in ascending order. */
+  for (i = 0; i < CLASSIFIER_RANK_MAX_IDS && next < CLASSIFIER_RANK_UNKNOWN;
+      i++) {
+    if (present[i])
+      rank->ranks[i] = next++;
+  }
+}
+
+guint
+classifier_rank_order (const NvDsClassifierRank * rank, NvDsObjectMeta * obj,
+    NvDsClassifierMeta ** ordered)
+{
+  NvDsClassifierMeta *metas[MAX_OBJECT_CLASSIFIERS];
+  guint8 ranks[MAX_OBJECT_CLASSIFIERS];
+  guint start[CLASSIFIER_RANK_UNKNOWN + 1] = { 0 };
+  guint num = 0, pos = 0;
+
+  for (NvDsMetaList * l_class = obj->classifier_meta_list;
+      l_class != NULL && num < MAX_OBJECT_CLASSIFIERS;
+      l_class = l_class->next) {
+    NvDsClassifierMeta *cmeta = (NvDsClassifierMeta *) l_class->data;
+
+    metas[num] = cmeta;
+    ranks[num] = classifier_rank_lookup (rank, cmeta->unique_component_id);
+    start[ranks[num]]++;
+    num++;
+  }
+
+  if (num == 1) {
+    ordered[0] = metas[0];
+    return 1;
+  }
+
+  for (guint r = 0; r <= CLASSIFIER_RANK_UNKNOWN; r++) {
+    guint count = start[r];
+    start[r] = pos;
+    pos += count;
+  }
+  for (guint i = 0; i < num; i++)
+    ordered[start[ranks[i]]++] = metas[i];
+  return num;
+}
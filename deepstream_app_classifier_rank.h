@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_CLASSIFIER_RANK_H__
+#define __NVGSTDS_APP_CLASSIFIER_RANK_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+#include "nvdsmeta.h"
+#include "deepstream_config.h"
+
+/** Component ids whose classifier labels are ordered by a direct index. */
+#define CLASSIFIER_RANK_MAX_IDS 256
+/** Rank of classifiers from components that are not a configured GIE. */
+#define CLASSIFIER_RANK_UNKNOWN (MAX_SECONDARY_GIE_BINS + 1)
+/** Classifiers of one object whose labels are displayed. */
+#define MAX_OBJECT_CLASSIFIERS 32
+
+/** Display order of classifier labels, by component id. */
+typedef struct
+{
+  guint8 ranks[CLASSIFIER_RANK_MAX_IDS];
+} NvDsClassifierRank;
+
+/**
+ * Rank the GIEs by unique id, the order their classifier labels are joined
+ * in. Done once so objects do not need their classifier list sorted.
+ */
+void classifier_rank_init (NvDsClassifierRank * rank, const guint * ids,
+    guint num_ids);
+
+/** Rank of a GIE in the display order of classifier labels. */
+static inline guint
+classifier_rank_lookup (const NvDsClassifierRank * rank,
+    gint unique_component_id)
+{
+  if ((guint) unique_component_id < CLASSIFIER_RANK_MAX_IDS)
+    return rank->ranks[unique_component_id];
+  return CLASSIFIER_RANK_UNKNOWN;
+}
+
+/**
+ * Gather the classifiers of an object in rank order, keeping the list
+ * order within a rank. Classifiers past MAX_OBJECT_CLASSIFIERS are left
+ * out, their labels would not fit the display text anyway.
+ *
+ * @param[out] ordered array of MAX_OBJECT_CLASSIFIERS entries.
+ *
+ * @return number of classifiers in @p ordered.
+ */
+guint classifier_rank_order (const NvDsClassifierRank * rank,
+    NvDsObjectMeta * obj, NvDsClassifierMeta ** ordered);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
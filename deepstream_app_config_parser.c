@@ -28,6 +28,35 @@
 #define CONFIG_GROUP_APP_PERF_MEASUREMENT_INTERVAL "perf-measurement-interval-sec"
 #define CONFIG_GROUP_APP_GIE_OUTPUT_DIR "gie-kitti-output-dir"
 #define CONFIG_GROUP_APP_GIE_TRACK_OUTPUT_DIR "kitti-track-output-dir"
+#define CONFIG_GROUP_APP_KITTI_OUTPUT_SYNC "kitti-output-sync"
+#define CONFIG_GROUP_APP_KITTI_OUTPUT_FORMAT "kitti-output-format"
+#define CONFIG_GROUP_APP_TARGET_GATE_RADIUS "target-gate-radius"
+#define CONFIG_GROUP_APP_TARGET_CLASSES "target-classes"
+#define CONFIG_GROUP_APP_TARGET_MAX_COAST "target-max-coast-ms"
+#define CONFIG_GROUP_APP_COUNT_SHM_NAME "count-shm-name"
+#define CONFIG_GROUP_APP_COUNT_SHM_FRAMES "count-shm-frames"
+#define CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_LATENCY "adaptive-interval-latency-ms"
+#define CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_FPS "adaptive-interval-fps"
+#define CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_MAX "adaptive-interval-max"
+#define CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_PERIOD "adaptive-interval-period-ms"
+#define CONFIG_GROUP_APP_ROI_GIE_CONFIG_FILE "roi-gie-config-file"
+#define CONFIG_GROUP_APP_ROI_COMPONENT_ID "roi-component-id"
+#define CONFIG_GROUP_APP_ROI_SCALE "roi-scale"
+#define CONFIG_GROUP_APP_ROI_MIN_SIZE "roi-min-size"
+
+#define CONFIG_GROUP_TELEMETRY "telemetry"
+#define CONFIG_GROUP_TELEMETRY_ENABLE "enable"
+#define CONFIG_GROUP_TELEMETRY_TYPE "type"
+#define CONFIG_GROUP_TELEMETRY_HOST "host"
+#define CONFIG_GROUP_TELEMETRY_PORT "port"
+#define CONFIG_GROUP_TELEMETRY_MULTICAST_IFACE "multicast-iface"
+#define CONFIG_GROUP_TELEMETRY_MULTICAST_TTL "multicast-ttl"
+#define CONFIG_GROUP_TELEMETRY_PATH "path"
+#define CONFIG_GROUP_TELEMETRY_PERIOD "period-ms"
+#define CONFIG_GROUP_TELEMETRY_EVENT_DRIVEN "event-driven"
+#define CONFIG_GROUP_TELEMETRY_FORMAT "format"
+#define CONFIG_GROUP_TELEMETRY_STREAM_ID "stream-id"
+#define CONFIG_GROUP_TELEMETRY_LATENCY_COMPENSATION "latency-compensation"
 
 #define CONFIG_GROUP_TESTS "tests"
 #define CONFIG_GROUP_TESTS_FILE_LOOP "file-loop"
@@ -189,6 +218,107 @@ done:
   return ret;
 }
 
+static gboolean
+parse_telemetry (NvDsTelemetryConfig *config, GKeyFile *key_file,
+    gchar *group)
+{
+  gboolean ret = FALSE;
+  gchar **keys = NULL;
+  gchar **key = NULL;
+  GError *error = NULL;
+
+  telemetry_config_set_defaults (config);
+  config->enable = FALSE;
+
+  keys = g_key_file_get_keys (key_file, group, NULL, &error);
+  CHECK_ERROR (error);
+
+  for (key = keys; *key; key++) {
+    if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_ENABLE)) {
+      config->enable =
+          g_key_file_get_boolean (key_file, group,
+          CONFIG_GROUP_TELEMETRY_ENABLE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_TYPE)) {
+      config->type =
+          g_key_file_get_integer (key_file, group,
+          CONFIG_GROUP_TELEMETRY_TYPE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_HOST)) {
+      g_free (config->host);
+      config->host =
+          g_key_file_get_string (key_file, group,
+          CONFIG_GROUP_TELEMETRY_HOST, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_PORT)) {
+      config->port =
+          g_key_file_get_integer (key_file, group,
+          CONFIG_GROUP_TELEMETRY_PORT, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_MULTICAST_IFACE)) {
+      config->multicast_iface =
+          g_key_file_get_string (key_file, group,
+          CONFIG_GROUP_TELEMETRY_MULTICAST_IFACE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_MULTICAST_TTL)) {
+      config->multicast_ttl =
+          g_key_file_get_integer (key_file, group,
+          CONFIG_GROUP_TELEMETRY_MULTICAST_TTL, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_PATH)) {
+      config->path =
+          g_key_file_get_string (key_file, group,
+          CONFIG_GROUP_TELEMETRY_PATH, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_PERIOD)) {
+      config->period_ms =
+          g_key_file_get_integer (key_file, group,
+          CONFIG_GROUP_TELEMETRY_PERIOD, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_EVENT_DRIVEN)) {
+      config->event_driven =
+          g_key_file_get_boolean (key_file, group,
+          CONFIG_GROUP_TELEMETRY_EVENT_DRIVEN, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_FORMAT)) {
+      config->format =
+          g_key_file_get_integer (key_file, group,
+          CONFIG_GROUP_TELEMETRY_FORMAT, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_STREAM_ID)) {
+      config->stream_id =
+          g_key_file_get_integer (key_file, group,
+          CONFIG_GROUP_TELEMETRY_STREAM_ID, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_TELEMETRY_LATENCY_COMPENSATION)) {
+      config->latency_compensation =
+          g_key_file_get_boolean (key_file, group,
+          CONFIG_GROUP_TELEMETRY_LATENCY_COMPENSATION, &error);
+      CHECK_ERROR (error);
+    } else {
+      NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key, group);
+    }
+  }
+
+  if (config->type == NV_DS_TELEMETRY_UNIX && !config->path) {
+    NVGSTDS_ERR_MSG_V ("[%s] needs a socket path", group);
+    goto done;
+  }
+
+  ret = TRUE;
+done:
+  if (error) {
+    g_error_free (error);
+  }
+  if (keys) {
+    g_strfreev (keys);
+  }
+  if (!ret) {
+    NVGSTDS_ERR_MSG_V ("%s failed", __func__);
+  }
+  return ret;
+}
+
 static gboolean
 parse_app (NvDsConfig *config, GKeyFile *key_file, gchar *cfg_file_path)
 {
@@ -221,6 +351,82 @@ parse_app (NvDsConfig *config, GKeyFile *key_file, gchar *cfg_file_path)
           g_key_file_get_string (key_file, CONFIG_GROUP_APP,
           CONFIG_GROUP_APP_GIE_TRACK_OUTPUT_DIR, &error));
       CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_KITTI_OUTPUT_SYNC)) {
+      config->kitti_output_sync =
+          g_key_file_get_boolean (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_KITTI_OUTPUT_SYNC, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_KITTI_OUTPUT_FORMAT)) {
+      config->kitti_output_format =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_KITTI_OUTPUT_FORMAT, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_TARGET_GATE_RADIUS)) {
+      config->target_gate_radius =
+          g_key_file_get_double (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_TARGET_GATE_RADIUS, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_TARGET_CLASSES)) {
+      config->target_classes =
+          g_key_file_get_string_list (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_TARGET_CLASSES, NULL, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_TARGET_MAX_COAST)) {
+      config->target_max_coast_ms =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_TARGET_MAX_COAST, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_COUNT_SHM_NAME)) {
+      config->count_shm_name =
+          g_key_file_get_string (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_COUNT_SHM_NAME, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_COUNT_SHM_FRAMES)) {
+      config->count_shm_frames =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_COUNT_SHM_FRAMES, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_LATENCY)) {
+      config->interval_ctl_config.target_latency_ms =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_LATENCY, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_FPS)) {
+      config->interval_ctl_config.target_fps =
+          g_key_file_get_double (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_FPS, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_MAX)) {
+      config->interval_ctl_config.max_interval =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_MAX, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_PERIOD)) {
+      config->interval_ctl_config.period_ms =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_ADAPTIVE_INTERVAL_PERIOD, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_ROI_GIE_CONFIG_FILE)) {
+      config->roi_config.config_file_path =
+          get_absolute_file_path (cfg_file_path,
+          g_key_file_get_string (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_ROI_GIE_CONFIG_FILE, &error));
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_ROI_COMPONENT_ID)) {
+      config->roi_config.component_id =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_ROI_COMPONENT_ID, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_ROI_SCALE)) {
+      config->roi_config.scale =
+          g_key_file_get_double (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_ROI_SCALE, &error);
+      CHECK_ERROR (error);
+    } else if (!g_strcmp0 (*key, CONFIG_GROUP_APP_ROI_MIN_SIZE)) {
+      config->roi_config.min_size =
+          g_key_file_get_integer (key_file, CONFIG_GROUP_APP,
+          CONFIG_GROUP_APP_ROI_MIN_SIZE, &error);
+      CHECK_ERROR (error);
     } else {
       NVGSTDS_WARN_MSG_V ("Unknown key '%s' for group [%s]", *key,
                           CONFIG_GROUP_APP);
@@ -434,6 +640,26 @@ parse_config_file (NvDsConfig *config, gchar *cfg_file_path)
       parse_err = !parse_tests (config, cfg_file);
     }
 
+    if (!strncmp (*group, CONFIG_GROUP_TELEMETRY,
+            sizeof (CONFIG_GROUP_TELEMETRY) - 1)) {
+      NvDsTelemetryConfig *telemetry_config;
+      if (config->num_telemetry_destinations == MAX_TELEMETRY_DESTINATIONS) {
+        NVGSTDS_ERR_MSG_V ("App supports max %d telemetry destinations",
+            MAX_TELEMETRY_DESTINATIONS);
+        ret = FALSE;
+        goto done;
+      }
+      telemetry_config =
+          &config->telemetry_config[config->num_telemetry_destinations];
+      parse_err = !parse_telemetry (telemetry_config, cfg_file, *group);
+      if (!parse_err && telemetry_config->enable) {
+        config->num_telemetry_destinations++;
+      } else {
+        /* The next [telemetry] group reuses the slot. */
+        telemetry_config_clear (telemetry_config);
+      }
+    }
+
     if (parse_err) {
       GST_CAT_ERROR (APP_CFG_PARSER_CAT, "Failed to parse '%s' group", *group);
       goto done;
@@ -487,6 +713,21 @@ parse_config_file (NvDsConfig *config, gchar *cfg_file_path)
           g_strdup_printf (config->multi_source_config[i].uri, 0);
     }
   }
+
+  if (!config->target_classes) {
+    config->target_classes = g_new0 (gchar *, 2);
+    config->target_classes[0] = g_strdup ("person");
+  }
+  if (!class_filter_init (&config->target_class_filter,
+          config->target_classes, config->primary_gie_config.unique_id,
+          config->primary_gie_config.label_file_path)) {
+    NVGSTDS_ERR_MSG_V ("Failed to resolve '%s'",
+        CONFIG_GROUP_APP_TARGET_CLASSES);
+    ret = FALSE;
+    goto done;
+  }
+  g_strfreev (config->target_classes);
+  config->target_classes = NULL;
   ret = TRUE;
 
 done:
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "deepstream_common.h"
+#include "deepstream_app_count_shm.h"
+
+#define COUNT_SHM_ALIGN(x) (((x) + 63) & ~(gsize) 63)
+
+#define WINDOW_1S_US G_TIME_SPAN_SECOND
+#define WINDOW_10S_US (10 * G_TIME_SPAN_SECOND)
+
+typedef struct
+{
+  NvDsCountShmStream *shared;
+  NvDsCountShmFrame *ring;
+  /** Frames written, mirrors shared->head. */
+  guint64 head;
+  /** Oldest frame still counted in each window. */
+  guint64 tail_1s;
+  guint64 tail_10s;
+} NvDsCountShmStreamState;
+
+struct _NvDsCountShm
+{
+  gchar *name;
+  gpointer base;
+  gsize size;
+  guint ring_frames;
+  guint num_streams;
+  NvDsCountShmStreamState *streams;
+};
+
+NvDsCountShm *
+count_shm_open (const gchar * name, guint num_streams, guint ring_frames,
+    guint instance)
+{
+  NvDsCountShm *shm;
+  NvDsCountShmHeader *header;
+  gsize stream_size, stream_offset;
+  guint i;
+  int fd;
+
+  if (!ring_frames)
+    ring_frames = COUNT_SHM_DEFAULT_FRAMES;
+
+  stream_offset = COUNT_SHM_ALIGN (sizeof (NvDsCountShmHeader));
+  stream_size = COUNT_SHM_ALIGN (sizeof (NvDsCountShmStream) +
+      (gsize) ring_frames * sizeof (NvDsCountShmFrame));
+
+  shm_unlink (name);
+  fd = shm_open (name, O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    NVGSTDS_ERR_MSG_V ("Failed to create shared memory '%s': %s", name,
+        strerror (errno));
+    return NULL;
+  }
+
+  shm = g_new0 (NvDsCountShm, 1);
+  shm->size = stream_offset + stream_size * num_streams;
+  if (ftruncate (fd, shm->size) < 0) {
+    NVGSTDS_ERR_MSG_V ("Failed to size shared memory '%s': %s", name,
+        strerror (errno));
+    goto error;
+  }
+  shm->base = mmap (NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+      0);
+  if (shm->base == MAP_FAILED) {
+    shm->base = NULL;
+    NVGSTDS_ERR_MSG_V ("Failed to map shared memory '%s': %s", name,
+        strerror (errno));
+    goto error;
+  }
+  close (fd);
+  fd = -1;
+
+  shm->name = g_strdup (name);
+  shm->ring_frames = ring_frames;
+  shm->num_streams = num_streams;
+  shm->streams = g_new0 (NvDsCountShmStreamState, num_streams);
+  for (i = 0; i < num_streams; i++) {
+    guint8 *stream = (guint8 *) shm->base + stream_offset + stream_size * i;
+    shm->streams[i].shared = (NvDsCountShmStream *) stream;
+    shm->streams[i].ring =
+        (NvDsCountShmFrame *) (stream + sizeof (NvDsCountShmStream));
+  }
+
+  /* The object is zero filled; readers wait for the magic. */
+  header = (NvDsCountShmHeader *) shm->base;
+  header->version = COUNT_SHM_VERSION;
+  header->num_streams = num_streams;
+  header->num_classes = COUNT_SHM_CLASSES;
+  header->ring_frames = ring_frames;
+  header->instance = instance;
+  header->stream_offset = stream_offset;
+  header->stream_size = stream_size;
+  __atomic_store_n (&header->magic, COUNT_SHM_MAGIC, __ATOMIC_RELEASE);
+  return shm;
+
+error:
+  close (fd);
+  shm_unlink (name);
+  g_free (shm);
+  return NULL;
+}
+
+void
+count_shm_close (NvDsCountShm * shm)
+{
+  if (!shm)
+    return;
+
+  munmap (shm->base, shm->size);
+  shm_unlink (shm->name);
+  g_free (shm->name);
+  g_free (shm->streams);
+  g_free (shm);
+}
+
+/**
+ * Add a frame to a window and drop the frames that left it: those older
+ * than @p min_time and those before @p min_index, about to be overwritten.
+ */
+static void
+window_update (NvDsCountShm * shm, NvDsCountShmStreamState * stream,
+    NvDsCountShmWindow * window, guint64 * tail, NvDsCountShmFrame * added,
+    gint64 min_time, guint64 min_index)
+{
+  guint64 seq = __atomic_load_n (&window->seq, __ATOMIC_RELAXED);
+  guint i;
+
+  __atomic_store_n (&window->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+
+  if (added) {
+    for (i = 0; i < COUNT_SHM_CLASSES; i++)
+      window->counts[i] += added->counts[i];
+    window->frames++;
+  }
+  while (*tail < stream->head) {
+    NvDsCountShmFrame *frame = &stream->ring[*tail % shm->ring_frames];
+    if (*tail >= min_index && frame->monotonic_us >= min_time)
+      break;
+    for (i = 0; i < COUNT_SHM_CLASSES; i++)
+      window->counts[i] -= frame->counts[i];
+    window->frames--;
+    (*tail)++;
+  }
+
+  __atomic_store_n (&window->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+guint32 *
+count_shm_begin_frame (NvDsCountShm * shm, guint stream_id)
+{
+  NvDsCountShmStreamState *stream;
+  NvDsCountShmFrame *frame;
+
+  if (!shm || stream_id >= shm->num_streams)
+    return NULL;
+
+  stream = &shm->streams[stream_id];
+  if (stream->head >= shm->ring_frames) {
+    guint64 min_index = stream->head - shm->ring_frames + 1;
+    if (stream->tail_1s < min_index)
+      window_update (shm, stream, &stream->shared->window_1s,
+          &stream->tail_1s, NULL, G_MININT64, min_index);
+    if (stream->tail_10s < min_index)
+      window_update (shm, stream, &stream->shared->window_10s,
+          &stream->tail_10s, NULL, G_MININT64, min_index);
+  }
+
+  frame = &stream->ring[stream->head % shm->ring_frames];
+  __atomic_store_n (&frame->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+  memset (frame->counts, 0, sizeof (frame->counts));
+  return frame->counts;
+}
+
+void
+count_shm_end_frame (NvDsCountShm * shm, guint stream_id, guint64 frame_num)
+{
+  NvDsCountShmStreamState *stream;
+  NvDsCountShmFrame *frame;
+  gint64 now;
+
+  if (!shm || stream_id >= shm->num_streams)
+    return;
+
+  stream = &shm->streams[stream_id];
+  frame = &stream->ring[stream->head % shm->ring_frames];
+  now = g_get_monotonic_time ();
+  frame->frame_num = frame_num;
+  frame->real_time_us = g_get_real_time ();
+  frame->monotonic_us = now;
+  __atomic_store_n (&frame->seq, stream->head + 1, __ATOMIC_RELEASE);
+
+  stream->head++;
+  __atomic_store_n (&stream->shared->head, stream->head, __ATOMIC_RELEASE);
+
+  window_update (shm, stream, &stream->shared->window_1s, &stream->tail_1s,
+      frame, now - WINDOW_1S_US, 0);
+  window_update (shm, stream, &stream->shared->window_10s, &stream->tail_10s,
+      frame, now - WINDOW_10S_US, 0);
+}
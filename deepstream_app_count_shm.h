@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_COUNT_SHM_H__
+#define __NVGSTDS_APP_COUNT_SHM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "deepstream_app_count_shm_format.h"
+
+/** Ring slots per stream when not configured, about 30 s at 30 fps. */
+#define COUNT_SHM_DEFAULT_FRAMES 1024
+
+typedef struct _NvDsCountShm NvDsCountShm;
+
+/**
+ * Create the shared memory object, replacing a stale one of the same name.
+ *
+ * @param[in] name shm_open() name, e.g. "/deepstream_counts_00".
+ * @param[in] ring_frames ring slots per stream, 0 for the default.
+ *
+ * @return NULL on error.
+ */
+NvDsCountShm *count_shm_open (const gchar * name, guint num_streams,
+    guint ring_frames, guint instance);
+
+/** Unmap and unlink the object. */
+void count_shm_close (NvDsCountShm * shm);
+
+/**
+ * Start the counts of the next frame of a stream, from its streaming
+ * thread. Close the frame with count_shm_end_frame().
+ *
+ * @return zeroed per class counts, NULL if @p stream_id is out of range.
+ */
+guint32 *count_shm_begin_frame (NvDsCountShm * shm, guint stream_id);
+
+void count_shm_end_frame (NvDsCountShm * shm, guint stream_id,
+    guint64 frame_num);
+
+static inline void
+count_shm_count_object (guint32 * counts, gint class_id)
+{
+  if (counts && (guint) class_id < COUNT_SHM_CLASSES)
+    counts[class_id]++;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
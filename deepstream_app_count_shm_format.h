@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_COUNT_SHM_FORMAT_H__
+#define __NVGSTDS_APP_COUNT_SHM_FORMAT_H__
+
+/*
+ * Layout of the shared memory object holding per stream, per class object
+ * counts, for readers mapping it read only. Every frame written gets one
+ * ring slot, and the counts of the frames seen in the last second and the
+ * last ten seconds are kept up to date next to the ring.
+ *
+ *   NvDsCountShmHeader
+ *   stream 0 .. num_streams-1, stream_size bytes each, at stream_offset:
+ *     NvDsCountShmStream
+ *     NvDsCountShmFrame[ring_frames]
+ *
+ * Readers need no syscall:
+ *  - a ring slot is valid when its seq, read with acquire semantics before
+ *    and after copying it, equals the frame index + 1 (0 while written);
+ *    the latest frame index is head - 1, and slot i holds frame index
+ *    i % ring_frames.
+ *  - a window is consistent when its seq is even and unchanged after
+ *    copying it.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define COUNT_SHM_MAGIC 0x5343444eu     /* "NDCS" */
+#define COUNT_SHM_VERSION 1
+/** Primary GIE classes counted per frame. */
+#define COUNT_SHM_CLASSES 128
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_streams;
+  uint32_t num_classes;
+  uint32_t ring_frames;
+  /** Instance that writes the counts. */
+  uint32_t instance;
+  uint64_t stream_offset;
+  uint64_t stream_size;
+} NvDsCountShmHeader;
+
+typedef struct
+{
+  uint64_t seq;
+  /** Frames in the window and their summed counts. */
+  uint64_t frames;
+  uint32_t counts[COUNT_SHM_CLASSES];
+} NvDsCountShmWindow;
+
+typedef struct
+{
+  /** Number of frames written so far. */
+  uint64_t head;
+  uint64_t reserved;
+  NvDsCountShmWindow window_1s;
+  NvDsCountShmWindow window_10s;
+} NvDsCountShmStream;
+
+typedef struct
+{
+  uint64_t seq;
+  uint64_t frame_num;
+  /** Wall clock time, for display. */
+  int64_t real_time_us;
+  /** Monotonic time, the windows are based on. */
+  int64_t monotonic_us;
+  uint32_t counts[COUNT_SHM_CLASSES];
+} NvDsCountShmFrame;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
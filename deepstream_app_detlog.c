@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <string.h>
+
+#include "deepstream_common.h"
+#include "deepstream_app_detlog.h"
+
+struct _NvDsDetLog
+{
+  NvDsKittiWriter *writer;
+  NvDsKittiWriterProducer producer;
+  gchar *path;
+  /** File offset the next chunk will be written at. */
+  guint64 offset;
+  GArray *index;
+  guint dropped_chunks;
+
+  /* Pending chunk. */
+  guint num_rows;
+  guint64 frame_num[DETLOG_CHUNK_ROWS];
+  guint64 object_id[DETLOG_CHUNK_ROWS];
+  guint32 stream_id[DETLOG_CHUNK_ROWS];
+  gint32 class_id[DETLOG_CHUNK_ROWS];
+  guint16 label[DETLOG_CHUNK_ROWS];
+  gfloat left[DETLOG_CHUNK_ROWS];
+  gfloat top[DETLOG_CHUNK_ROWS];
+  gfloat width[DETLOG_CHUNK_ROWS];
+  gfloat height[DETLOG_CHUNK_ROWS];
+  guint64 first_frame;
+  guint64 last_frame;
+
+  /* Labels of the pending chunk, keyed by GIE and class id. */
+  guint num_labels;
+  gint label_gie[DETLOG_MAX_LABELS];
+  gint label_class[DETLOG_MAX_LABELS];
+  gchar labels[DETLOG_MAX_LABELS][DETLOG_LABEL_SIZE];
+};
+
+/** Queue @p data to be appended; keeps the file offset in sync. */
+static gboolean
+detlog_push (NvDsDetLog * log, GString * data, gboolean append)
+{
+  gsize len = data->len;
+
+  if (!kitti_writer_push (log->writer, log->producer, g_strdup (log->path),
+          data, append))
+    return FALSE;
+  log->offset += len;
+  return TRUE;
+}
+
+static void
+detlog_put_column (GString * data, gsize offset, gconstpointer column,
+    gsize size)
+{
+  memcpy (data->str + offset, column, size);
+}
+
+static void
+detlog_flush_chunk (NvDsDetLog * log)
+{
+  NvDsDetLogChunkHeader header = { 0 };
+  NvDsDetLogChunkLayout layout;
+  NvDsDetLogIndexEntry entry = { 0 };
+  guint n = log->num_rows;
+  GString *data;
+
+  if (!n)
+    return;
+
+  detlog_chunk_layout (n, log->num_labels, &layout);
+  data = g_string_sized_new (layout.size);
+  g_string_set_size (data, layout.size);
+  memset (data->str, 0, layout.size);
+
+  header.magic = DETLOG_CHUNK_MAGIC;
+  header.num_rows = n;
+  header.num_labels = log->num_labels;
+  memcpy (data->str, &header, sizeof (header));
+  detlog_put_column (data, layout.frame_num, log->frame_num,
+      n * sizeof (log->frame_num[0]));
+  detlog_put_column (data, layout.object_id, log->object_id,
+      n * sizeof (log->object_id[0]));
+  detlog_put_column (data, layout.stream_id, log->stream_id,
+      n * sizeof (log->stream_id[0]));
+  detlog_put_column (data, layout.class_id, log->class_id,
+      n * sizeof (log->class_id[0]));
+  detlog_put_column (data, layout.label, log->label,
+      n * sizeof (log->label[0]));
+  detlog_put_column (data, layout.left, log->left, n * sizeof (log->left[0]));
+  detlog_put_column (data, layout.top, log->top, n * sizeof (log->top[0]));
+  detlog_put_column (data, layout.width, log->width,
+      n * sizeof (log->width[0]));
+  detlog_put_column (data, layout.height, log->height,
+      n * sizeof (log->height[0]));
+  detlog_put_column (data, layout.labels, log->labels,
+      log->num_labels * DETLOG_LABEL_SIZE);
+
+  entry.offset = log->offset;
+  entry.first_frame = log->first_frame;
+  entry.last_frame = log->last_frame;
+  entry.num_rows = n;
+  if (detlog_push (log, data, TRUE))
+    g_array_append_val (log->index, entry);
+  else
+    log->dropped_chunks++;
+
+  log->num_rows = 0;
+  log->num_labels = 0;
+}
+
+static gint
+detlog_label_index (NvDsDetLog * log, gint gie_id, gint class_id,
+    const gchar * label)
+{
+  guint i;
+
+  for (i = 0; i < log->num_labels; i++) {
+    if (log->label_class[i] == class_id && log->label_gie[i] == gie_id)
+      return i;
+  }
+
+  if (log->num_labels == DETLOG_MAX_LABELS)
+    return -1;
+
+  log->label_gie[i] = gie_id;
+  log->label_class[i] = class_id;
+  g_strlcpy (log->labels[i], label ? label : "", DETLOG_LABEL_SIZE);
+  log->num_labels++;
+  return i;
+}
+
+/** Start a row of the pending chunk, which must not be full. */
+static guint
+detlog_add_row (NvDsDetLog * log, guint64 frame_num, guint stream_id)
+{
+  guint n = log->num_rows++;
+
+  if (!n || frame_num < log->first_frame)
+    log->first_frame = frame_num;
+  if (!n || frame_num > log->last_frame)
+    log->last_frame = frame_num;
+  log->frame_num[n] = frame_num;
+  log->stream_id[n] = stream_id;
+  return n;
+}
+
+NvDsDetLog *
+detlog_open (NvDsKittiWriter * writer, NvDsKittiWriterProducer producer,
+    const gchar * path, guint instance)
+{
+  NvDsDetLog *log = g_new0 (NvDsDetLog, 1);
+  NvDsDetLogFileHeader header = { 0 };
+  GString *data = g_string_sized_new (sizeof (header));
+
+  log->writer = writer;
+  log->producer = producer;
+  log->path = g_strdup (path);
+  log->index = g_array_new (FALSE, FALSE, sizeof (NvDsDetLogIndexEntry));
+
+  header.magic = DETLOG_FILE_MAGIC;
+  header.version = DETLOG_VERSION;
+  header.instance = instance;
+  header.byte_order = DETLOG_BYTE_ORDER;
+  g_string_append_len (data, (const gchar *) &header, sizeof (header));
+  if (!detlog_push (log, data, FALSE)) {
+    NVGSTDS_ERR_MSG_V ("Failed to start detection log %s", path);
+    g_array_free (log->index, TRUE);
+    g_free (log->path);
+    g_free (log);
+    return NULL;
+  }
+  return log;
+}
+
+void
+detlog_append (NvDsDetLog * log, guint64 frame_num, guint stream_id,
+    gint gie_id, gint class_id, const gchar * label, guint64 object_id,
+    gfloat left, gfloat top, gfloat width, gfloat height)
+{
+  gint label_index = detlog_label_index (log, gie_id, class_id, label);
+  guint n;
+
+  if (label_index < 0 || log->num_rows == DETLOG_CHUNK_ROWS) {
+    detlog_flush_chunk (log);
+    label_index = detlog_label_index (log, gie_id, class_id, label);
+  }
+
+  n = detlog_add_row (log, frame_num, stream_id);
+  log->object_id[n] = object_id;
+  log->class_id[n] = class_id;
+  log->label[n] = label_index;
+  log->left[n] = left;
+  log->top[n] = top;
+  log->width[n] = width;
+  log->height[n] = height;
+}
+
+void
+detlog_append_empty_frame (NvDsDetLog * log, guint64 frame_num,
+    guint stream_id)
+{
+  guint n;
+
+  if (log->num_rows == DETLOG_CHUNK_ROWS)
+    detlog_flush_chunk (log);
+
+  n = detlog_add_row (log, frame_num, stream_id);
+  log->object_id[n] = 0;
+  log->class_id[n] = 0;
+  log->label[n] = DETLOG_NO_OBJECT;
+  log->left[n] = 0;
+  log->top[n] = 0;
+  log->width[n] = 0;
+  log->height[n] = 0;
+}
+
+void
+detlog_close (NvDsDetLog * log)
+{
+  NvDsDetLogTrailer trailer = { 0 };
+  GString *data;
+
+  if (!log)
+    return;
+
+  detlog_flush_chunk (log);
+
+  trailer.index_offset = log->offset;
+  trailer.num_chunks = log->index->len;
+  trailer.magic = DETLOG_INDEX_MAGIC;
+  data = g_string_sized_new (log->index->len * sizeof (NvDsDetLogIndexEntry) +
+      sizeof (trailer));
+  g_string_append_len (data, log->index->data,
+      log->index->len * sizeof (NvDsDetLogIndexEntry));
+  g_string_append_len (data, (const gchar *) &trailer, sizeof (trailer));
+  detlog_push (log, data, TRUE);
+
+  if (log->dropped_chunks)
+    NVGSTDS_WARN_MSG_V ("%u chunks of %s dropped, writer fell behind",
+        log->dropped_chunks, log->path);
+
+  g_array_free (log->index, TRUE);
+  g_free (log->path);
+  g_free (log);
+}
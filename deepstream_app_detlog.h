@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_DETLOG_H__
+#define __NVGSTDS_APP_DETLOG_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "deepstream_app_detlog_format.h"
+#include "deepstream_app_kitti_writer.h"
+
+typedef struct _NvDsDetLog NvDsDetLog;
+
+/**
+ * Start a detection log. Rows are collected into column chunks on the
+ * calling thread; full chunks are written by the kitti writer thread.
+ *
+ * @param[in] writer kitti writer of the instance.
+ * @param[in] producer writer queue of the pad probe that appends rows.
+ * @param[in] path log file, replaced if it exists.
+ * @param[in] instance index of the application instance.
+ */
+NvDsDetLog *detlog_open (NvDsKittiWriter * writer,
+    NvDsKittiWriterProducer producer, const gchar * path, guint instance);
+
+/** Append one detection. Only called from the producer's thread. */
+void detlog_append (NvDsDetLog * log, guint64 frame_num, guint stream_id,
+    gint gie_id, gint class_id, const gchar * label, guint64 object_id,
+    gfloat left, gfloat top, gfloat width, gfloat height);
+
+/** Record a frame without detections. Only called from the producer's thread. */
+void detlog_append_empty_frame (NvDsDetLog * log, guint64 frame_num,
+    guint stream_id);
+
+/**
+ * Queue the pending chunk and the index and release the log. Must be
+ * called before the kitti writer is freed.
+ */
+void detlog_close (NvDsDetLog * log);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_DETLOG_FORMAT_H__
+#define __NVGSTDS_APP_DETLOG_FORMAT_H__
+
+/*
+ * On disk layout of the columnar detection log, shared with offline tools.
+ * All fields are in the byte order of the host that wrote the log, recorded
+ * in the file header, and every section starts 8 byte aligned, so a mapped
+ * file can be used in place on a host of the same byte order.
+ *
+ *   NvDsDetLogFileHeader
+ *   chunk 0 .. chunk N-1
+ *   NvDsDetLogIndexEntry[N]
+ *   NvDsDetLogTrailer
+ *
+ * A chunk is an NvDsDetLogChunkHeader followed by its columns, in the order
+ * given by detlog_chunk_layout(), and its label table. The index and the
+ * trailer are only written on a clean shutdown, and not after a chunk
+ * failed to be written; without them the chunks can still be walked from
+ * the file header.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define DETLOG_FILE_MAGIC 0x464c444eu   /* "NDLF" */
+#define DETLOG_CHUNK_MAGIC 0x434c444eu  /* "NDLC" */
+#define DETLOG_INDEX_MAGIC 0x494c444eu  /* "NDLI" */
+/** Version 2 adds DETLOG_NO_OBJECT rows and the byte order mark; version 1
+ *  logs are still read. */
+#define DETLOG_VERSION 2
+/** Written in host byte order, reads differently on a host of the other. */
+#define DETLOG_BYTE_ORDER 0x01020304u
+
+/** Maximum number of rows and distinct labels of one chunk. */
+#define DETLOG_CHUNK_ROWS 4096
+#define DETLOG_MAX_LABELS 256
+#define DETLOG_LABEL_SIZE 64
+/**
+ * Label index of a row that only records a frame without detections, so
+ * the frame still gets its (empty) KITTI file. Its other columns are 0.
+ */
+#define DETLOG_NO_OBJECT 0xffffu
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t version;
+  /** Instance that wrote the log. */
+  uint32_t instance;
+  /** DETLOG_BYTE_ORDER, 0 in version 1 logs. */
+  uint32_t byte_order;
+} NvDsDetLogFileHeader;
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t num_rows;
+  uint32_t num_labels;
+  uint32_t reserved;
+} NvDsDetLogChunkHeader;
+
+typedef struct
+{
+  uint64_t offset;
+  uint64_t first_frame;
+  uint64_t last_frame;
+  uint32_t num_rows;
+  uint32_t reserved;
+} NvDsDetLogIndexEntry;
+
+typedef struct
+{
+  uint64_t index_offset;
+  uint32_t num_chunks;
+  uint32_t magic;
+} NvDsDetLogTrailer;
+
+/** Byte offsets of the columns of a chunk, from the chunk header. */
+typedef struct
+{
+  size_t frame_num;             /* uint64_t */
+  size_t object_id;             /* uint64_t */
+  size_t stream_id;             /* uint32_t */
+  size_t class_id;              /* int32_t */
+  size_t label;                 /* uint16_t, index into the label table */
+  size_t left;                  /* float */
+  size_t top;                   /* float */
+  size_t width;                 /* float */
+  size_t height;                /* float */
+  size_t labels;                /* char[num_labels][DETLOG_LABEL_SIZE] */
+  size_t size;                  /* total chunk size */
+} NvDsDetLogChunkLayout;
+
+#define DETLOG_ALIGN(x) (((x) + 7) & ~(size_t) 7)
+
+static inline void
+detlog_chunk_layout (uint32_t num_rows, uint32_t num_labels,
+    NvDsDetLogChunkLayout * layout)
+{
+  size_t off = sizeof (NvDsDetLogChunkHeader);
+
+  layout->frame_num = off;
+  off += DETLOG_ALIGN (num_rows * sizeof (uint64_t));
+  layout->object_id = off;
+  off += DETLOG_ALIGN (num_rows * sizeof (uint64_t));
+  layout->stream_id = off;
+  off += DETLOG_ALIGN (num_rows * sizeof (uint32_t));
+  layout->class_id = off;
+  off += DETLOG_ALIGN (num_rows * sizeof (int32_t));
+  layout->label = off;
+  off += DETLOG_ALIGN (num_rows * sizeof (uint16_t));
+  layout->left = off;
+  off += DETLOG_ALIGN (num_rows * sizeof (float));
+  layout->top = off;
+  off += DETLOG_ALIGN (num_rows * sizeof (float));
+  layout->width = off;
+  off += DETLOG_ALIGN (num_rows * sizeof (float));
+  layout->height = off;
+  off += DETLOG_ALIGN (num_rows * sizeof (float));
+  layout->labels = off;
+  off += (size_t) num_labels * DETLOG_LABEL_SIZE;
+  layout->size = DETLOG_ALIGN (off);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
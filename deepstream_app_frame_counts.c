@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "deepstream_app_frame_counts.h"
+
+struct _NvDsFrameCounts
+{
+  NvDsSourceFrameCounts sources[MAX_SOURCE_BINS + 1];
+  /** Last cumulative dropped count by element, only used by the bus
+   * thread. */
+  GHashTable *qos_dropped;
+};
+
+NvDsFrameCounts *
+frame_counts_new (void)
+{
+  NvDsFrameCounts *counts;
+
+  if (posix_memalign ((gpointer *) & counts, FRAME_COUNTS_CACHE_LINE,
+          sizeof (NvDsFrameCounts)))
+    return NULL;
+  memset (counts, 0, sizeof (NvDsFrameCounts));
+  counts->qos_dropped = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+      gst_object_unref, g_free);
+  return counts;
+}
+
+void
+frame_counts_free (NvDsFrameCounts * counts)
+{
+  if (!counts)
+    return;
+
+  g_hash_table_destroy (counts->qos_dropped);
+  free (counts);
+}
+
+NvDsSourceFrameCounts *
+frame_counts_source (NvDsFrameCounts * counts, guint source_id)
+{
+  if (!counts || source_id > FRAME_COUNTS_OUTPUT)
+    return NULL;
+  return &counts->sources[source_id];
+}
+
+void
+frame_counts_add_qos (NvDsFrameCounts * counts, guint source_id,
+    GstMessage * message)
+{
+  NvDsSourceFrameCounts *source = frame_counts_source (counts, source_id);
+  GstObject *element = GST_MESSAGE_SRC (message);
+  GstFormat format;
+  guint64 processed, dropped, *last;
+  gint64 jitter;
+
+  if (!source)
+    return;
+
+  gst_message_parse_qos_values (message, &jitter, NULL, NULL);
+  if (jitter > 0)
+    frame_counts_add (source, NV_DS_FRAMES_LATE, 1);
+
+  gst_message_parse_qos_stats (message, &format, &processed, &dropped);
+  if (dropped == (guint64) - 1 || (format != GST_FORMAT_BUFFERS &&
+          format != GST_FORMAT_DEFAULT))
+    return;
+
+  last = g_hash_table_lookup (counts->qos_dropped, element);
+  if (!last) {
+    last = g_new0 (guint64, 1);
+    g_hash_table_insert (counts->qos_dropped, gst_object_ref (element), last);
+  }
+  /* The count restarts when the element is flushed or reset. */
+  if (dropped < *last)
+    *last = 0;
+  frame_counts_add (source, NV_DS_FRAMES_QOS_DROPPED, dropped - *last);
+  *last = dropped;
+}
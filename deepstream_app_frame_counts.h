@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_FRAME_COUNTS_H__
+#define __NVGSTDS_APP_FRAME_COUNTS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "deepstream_config.h"
+
+#define FRAME_COUNTS_CACHE_LINE 64
+/** Slot of the QoS events of the tiled or single stream output, which
+ * carries the frames of every source. */
+#define FRAME_COUNTS_OUTPUT MAX_SOURCE_BINS
+
+typedef enum
+{
+  /** Frames the source delivered to the muxer. */
+  NV_DS_FRAMES_DECODED,
+  /** Frames the muxer put into a batch. */
+  NV_DS_FRAMES_MUXED,
+  /** Frames the primary GIE ran inference on. */
+  NV_DS_FRAMES_INFERRED,
+  /** Frames handed to the ROI GIE as a window around the followed target. */
+  NV_DS_FRAMES_ROI,
+  /** Frames dropped by an element for QoS. */
+  NV_DS_FRAMES_QOS_DROPPED,
+  /** QoS events of frames that reached an element after their deadline. */
+  NV_DS_FRAMES_LATE,
+  NV_DS_FRAMES_NUM_COUNTERS
+} NvDsFrameCounter;
+
+/** Counters of one source, on a cache line of their own. */
+typedef struct
+{
+  guint64 counts[NV_DS_FRAMES_NUM_COUNTERS];
+} __attribute__ ((aligned (FRAME_COUNTS_CACHE_LINE))) NvDsSourceFrameCounts;
+
+typedef struct _NvDsFrameCounts NvDsFrameCounts;
+
+NvDsFrameCounts *frame_counts_new (void);
+void frame_counts_free (NvDsFrameCounts * counts);
+
+/**
+ * Counters of a source, or of FRAME_COUNTS_OUTPUT.
+ *
+ * @return NULL if @p source_id is out of range.
+ */
+NvDsSourceFrameCounts *frame_counts_source (NvDsFrameCounts * counts,
+    guint source_id);
+
+/**
+ * Account a QoS message of an element for a source, from the bus thread.
+ * Its cumulative dropped count is turned into the frames dropped since the
+ * element's previous message.
+ */
+void frame_counts_add_qos (NvDsFrameCounts * counts, guint source_id,
+    GstMessage * message);
+
+/** Add to a counter, from any streaming thread, without blocking. */
+static inline void
+frame_counts_add (NvDsSourceFrameCounts * source, NvDsFrameCounter counter,
+    guint64 n)
+{
+  if (source)
+    __atomic_fetch_add (&source->counts[counter], n, __ATOMIC_RELAXED);
+}
+
+/** Read a counter from any thread. */
+static inline guint64
+frame_counts_get (NvDsSourceFrameCounts * source, NvDsFrameCounter counter)
+{
+  return __atomic_load_n (&source->counts[counter], __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_common.h"
+#include "deepstream_app_interval_ctl.h"
+
+void
+interval_ctl_init (NvDsIntervalCtl * ctl, const NvDsIntervalCtlConfig * config,
+    guint interval)
+{
+  memset (ctl, 0, sizeof (*ctl));
+  ctl->config = *config;
+  if (!ctl->config.max_interval)
+    ctl->config.max_interval = INTERVAL_CTL_DEFAULT_MAX;
+  if (!ctl->config.period_ms)
+    ctl->config.period_ms = INTERVAL_CTL_DEFAULT_PERIOD_MS;
+  if (ctl->config.max_interval < interval)
+    ctl->config.max_interval = interval;
+  ctl->min_interval = interval;
+  ctl->interval = interval;
+  ctl->lower_periods = INTERVAL_CTL_LOWER_PERIODS;
+}
+
+/** p90 latency of the samples since the previous call, < 0 if too few. */
+static gdouble
+interval_ctl_latency (NvDsIntervalCtl * ctl, NvDsLatencyReporter * reporter,
+    guint component)
+{
+  guint64 counts[LATENCY_BUCKETS] = { 0 };
+  guint64 total;
+  guint i;
+
+  if (!reporter)
+    return -1;
+
+  total = latency_reporter_merge (reporter, component, counts);
+  if (total - ctl->latency_total < INTERVAL_CTL_MIN_FRAMES)
+    return -1;
+
+  for (i = 0; i < LATENCY_BUCKETS; i++) {
+    guint64 count = counts[i];
+    counts[i] -= ctl->latency_counts[i];
+    ctl->latency_counts[i] = count;
+  }
+  total -= ctl->latency_total;
+  ctl->latency_total += total;
+  return latency_counts_percentile (counts, total, 0.90);
+}
+
+/** Lowest fps of the streams that delivered frames, < 0 if not updated. */
+static gdouble
+interval_ctl_fps (NvDsIntervalCtl * ctl, const NvDsPerfSnapshot * perf)
+{
+  gdouble min_fps = -1;
+  guint i;
+
+  if (!perf || perf->updates == ctl->perf_updates)
+    return -1;
+  ctl->perf_updates = perf->updates;
+
+  /* A stream at 0 fps is down or at EOS, not slowed down by inference. */
+  for (i = 0; i < perf->num_streams; i++) {
+    if (perf->fps[i] > 0 && (min_fps < 0 || perf->fps[i] < min_fps))
+      min_fps = perf->fps[i];
+  }
+  return min_fps;
+}
+
+guint
+interval_ctl_update (NvDsIntervalCtl * ctl, NvDsLatencyReporter * reporter,
+    guint component, const NvDsPerfSnapshot * perf)
+{
+  NvDsIntervalCtlConfig *config = &ctl->config;
+  gdouble latency = -1, fps = -1;
+  gboolean over = FALSE, under = TRUE;
+  guint interval = ctl->interval;
+
+  if (config->target_latency_ms) {
+    latency = interval_ctl_latency (ctl, reporter, component);
+    if (latency >= 0) {
+      over |= latency > config->target_latency_ms * INTERVAL_CTL_HIGH;
+      under &= latency < config->target_latency_ms * INTERVAL_CTL_LOW;
+    } else {
+      under = FALSE;
+    }
+  }
+  if (config->target_fps > 0) {
+    fps = interval_ctl_fps (ctl, perf);
+    if (fps >= 0) {
+      over |= fps < config->target_fps / INTERVAL_CTL_HIGH;
+      under &= fps >= config->target_fps;
+    } else {
+      under = FALSE;
+    }
+  }
+
+  if (ctl->settle) {
+    ctl->settle--;
+    return interval;
+  }
+
+  if (over && interval < config->max_interval) {
+    /* Undoing a shortening: the target lies between this interval and the
+     * shorter one, try the shorter one less often. */
+    ctl->lower_periods = ctl->lowered ?
+        MIN (ctl->lower_periods * 2, INTERVAL_CTL_MAX_LOWER_PERIODS) :
+        INTERVAL_CTL_LOWER_PERIODS;
+    ctl->lowered = FALSE;
+    interval++;
+    ctl->good_periods = 0;
+  } else if (under && interval > ctl->min_interval) {
+    if (++ctl->good_periods >= ctl->lower_periods) {
+      ctl->lowered = TRUE;
+      interval--;
+      ctl->good_periods = 0;
+    }
+  } else {
+    ctl->good_periods = 0;
+  }
+
+  if (interval != ctl->interval) {
+    NVGSTDS_INFO_MSG_V ("Primary GIE interval %u -> %u (p90 latency %.1f ms, "
+        "min fps %.1f)", ctl->interval, interval, latency, fps);
+    __atomic_store_n (&ctl->interval, interval, __ATOMIC_RELAXED);
+    ctl->settle = INTERVAL_CTL_SETTLE_PERIODS;
+  }
+  return interval;
+}
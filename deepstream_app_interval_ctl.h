@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_INTERVAL_CTL_H__
+#define __NVGSTDS_APP_INTERVAL_CTL_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "deepstream_app_latency.h"
+#include "deepstream_app_perf_slot.h"
+
+/** Largest interval when adaptive-interval-max is not set. */
+#define INTERVAL_CTL_DEFAULT_MAX 4
+#define INTERVAL_CTL_DEFAULT_PERIOD_MS 1000
+/** Latency samples a period needs before the latency target is checked. */
+#define INTERVAL_CTL_MIN_FRAMES 30
+/** Overloaded above this fraction of the latency target, or below the
+ * inverse of it of the fps target. */
+#define INTERVAL_CTL_HIGH 1.1
+/** Fraction of the latency target under which a shorter interval is
+ * tried. */
+#define INTERVAL_CTL_LOW 0.7
+/** Periods without a decision after a change, so its effect is measured
+ * before the next one. */
+#define INTERVAL_CTL_SETTLE_PERIODS 2
+/** Consecutive underloaded periods before the interval is shortened,
+ * doubled up to INTERVAL_CTL_MAX_LOWER_PERIODS each time shortening it had
+ * to be undone. */
+#define INTERVAL_CTL_LOWER_PERIODS 5
+#define INTERVAL_CTL_MAX_LOWER_PERIODS 120
+
+typedef struct
+{
+  /** p90 end to end latency to hold, 0 for none. */
+  guint target_latency_ms;
+  /** Frame rate every active stream should keep, 0 for none. */
+  gdouble target_fps;
+  /** Longest interval; the configured one is the shortest. */
+  guint max_interval;
+  guint period_ms;
+} NvDsIntervalCtlConfig;
+
+/**
+ * Closed loop control of the primary GIE interval. Inference is skipped
+ * on more frames while the latency or fps target is missed, and on fewer
+ * once both are met with margin; the tracker fills the skipped frames.
+ * Raised after one bad period, lowered only after several good ones and
+ * ever more reluctantly when the target sits between two intervals, so the
+ * interval settles instead of oscillating.
+ */
+typedef struct
+{
+  NvDsIntervalCtlConfig config;
+  guint min_interval;
+  guint interval;
+  guint settle;
+  guint good_periods;
+  guint lower_periods;
+  /** Last change shortened the interval. */
+  gboolean lowered;
+  guint64 perf_updates;
+  /** Cumulative latency histogram at the previous update. */
+  guint64 latency_counts[LATENCY_BUCKETS];
+  guint64 latency_total;
+} NvDsIntervalCtl;
+
+/** Controllers are enabled by a latency or fps target. */
+static inline gboolean
+interval_ctl_enabled (const NvDsIntervalCtlConfig * config)
+{
+  return config->target_latency_ms || config->target_fps > 0;
+}
+
+void interval_ctl_init (NvDsIntervalCtl * ctl,
+    const NvDsIntervalCtlConfig * config, guint interval);
+
+/**
+ * Take the latency recorded and the fps published since the previous
+ * update into account, once per period.
+ *
+ * @param[in] reporter end to end latencies, NV_DS_LATENCY_FRAME of
+ *            @p component, or NULL if not measured.
+ * @param[in] perf latest numbers of the perf callback, or NULL.
+ *
+ * @return the interval to use from now on.
+ */
+guint interval_ctl_update (NvDsIntervalCtl * ctl,
+    NvDsLatencyReporter * reporter, guint component,
+    const NvDsPerfSnapshot * perf);
+
+/** Interval currently set, from any thread. */
+static inline guint
+interval_ctl_interval (NvDsIntervalCtl * ctl)
+{
+  return __atomic_load_n (&ctl->interval, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
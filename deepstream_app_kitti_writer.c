@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "deepstream_common.h"
+#include "deepstream_app_ring.h"
+#include "deepstream_app_kitti_writer.h"
+
+typedef struct
+{
+  gchar *path;
+  gchar *data;
+  gsize len;
+  gboolean append;
+} NvDsKittiRecord;
+
+struct _NvDsKittiWriter
+{
+  NvDsSpscRing rings[KITTI_WRITER_NUM_PRODUCERS];
+  gboolean sync;
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  gint waiting;
+  gint stop;
+  gint dropped;
+  /* Writer thread only. */
+  guint failed;
+  /** Files an append failed on; later appends to them are dropped. */
+  GHashTable *failed_paths;
+};
+
+static gboolean
+kitti_writer_write_record (NvDsKittiWriter * writer, NvDsKittiRecord * record,
+    gint * sync_fd)
+{
+  gint flags = O_WRONLY | O_CREAT | O_CLOEXEC |
+      (record->append ? O_APPEND : O_TRUNC);
+  gsize done = 0;
+  off_t start = 0;
+  gint fd;
+
+  /* Appended records only make sense in sequence, e.g. the chunks of a
+   * detection log the index refers to by offset. After a failure the file
+   * is cut back and left alone until it is replaced. */
+  if (!record->append)
+    g_hash_table_remove (writer->failed_paths, record->path);
+  else if (g_hash_table_contains (writer->failed_paths, record->path))
+    return FALSE;
+
+  fd = open (record->path, flags, 0644);
+  if (fd >= 0 && record->append)
+    start = lseek (fd, 0, SEEK_END);
+  if (fd < 0 || start < 0) {
+    if (fd >= 0)
+      close (fd);
+    if (record->append)
+      g_hash_table_add (writer->failed_paths, g_strdup (record->path));
+    return FALSE;
+  }
+
+  while (done < record->len) {
+    gssize ret = write (fd, record->data + done, record->len - done);
+    if (ret < 0 && errno == EINTR)
+      continue;
+    if (ret <= 0)
+      break;
+    done += ret;
+  }
+
+  if (done != record->len && record->append) {
+    if (ftruncate (fd, start) < 0)
+      NVGSTDS_WARN_MSG_V ("Failed to cut back %s", record->path);
+    g_hash_table_add (writer->failed_paths, g_strdup (record->path));
+  }
+
+  /* Keep the last file open, it names the file system to sync. */
+  if (writer->sync) {
+    if (*sync_fd >= 0)
+      close (*sync_fd);
+    *sync_fd = fd;
+  } else {
+    close (fd);
+  }
+  return done == record->len;
+}
+
+static void
+kitti_record_clear (NvDsKittiRecord * record)
+{
+  g_free (record->path);
+  g_free (record->data);
+}
+
+/** Write everything queued so far. Returns FALSE if nothing was queued. */
+static gboolean
+kitti_writer_drain (NvDsKittiWriter * writer)
+{
+  NvDsKittiRecord record;
+  gint sync_fd = -1;
+  gboolean any = FALSE;
+  guint i;
+
+  for (i = 0; i < KITTI_WRITER_NUM_PRODUCERS; i++) {
+    while (spsc_ring_pop (&writer->rings[i], &record)) {
+      if (!kitti_writer_write_record (writer, &record, &sync_fd))
+        writer->failed++;
+      kitti_record_clear (&record);
+      any = TRUE;
+    }
+  }
+
+  if (sync_fd >= 0) {
+    syncfs (sync_fd);
+    close (sync_fd);
+  }
+  return any;
+}
+
+static gpointer
+kitti_writer_thread_func (gpointer data)
+{
+  NvDsKittiWriter *writer = (NvDsKittiWriter *) data;
+  guint i;
+
+  while (!g_atomic_int_get (&writer->stop)) {
+    if (kitti_writer_drain (writer))
+      continue;
+
+    g_mutex_lock (&writer->lock);
+    g_atomic_int_set (&writer->waiting, 1);
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    for (i = 0; i < KITTI_WRITER_NUM_PRODUCERS; i++) {
+      if (spsc_ring_count (&writer->rings[i]))
+        break;
+    }
+    if (i == KITTI_WRITER_NUM_PRODUCERS && !g_atomic_int_get (&writer->stop))
+      g_cond_wait (&writer->cond, &writer->lock);
+    g_atomic_int_set (&writer->waiting, 0);
+    g_mutex_unlock (&writer->lock);
+  }
+
+  kitti_writer_drain (writer);
+  return NULL;
+}
+
+NvDsKittiWriter *
+kitti_writer_new (gboolean sync)
+{
+  NvDsKittiWriter *writer = g_new0 (NvDsKittiWriter, 1);
+  guint i;
+
+  writer->sync = sync;
+  writer->failed_paths =
+      g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  for (i = 0; i < KITTI_WRITER_NUM_PRODUCERS; i++) {
+    if (!spsc_ring_init (&writer->rings[i], sizeof (NvDsKittiRecord),
+            KITTI_WRITER_RING_SIZE)) {
+      NVGSTDS_ERR_MSG_V ("Failed to allocate kitti writer ring");
+      while (i--)
+        spsc_ring_deinit (&writer->rings[i]);
+      g_hash_table_destroy (writer->failed_paths);
+      g_free (writer);
+      return NULL;
+    }
+  }
+
+  g_mutex_init (&writer->lock);
+  g_cond_init (&writer->cond);
+  writer->thread = g_thread_new ("nvds-kitti-writer", kitti_writer_thread_func,
+      writer);
+  return writer;
+}
+
+gboolean
+kitti_writer_push (NvDsKittiWriter * writer, NvDsKittiWriterProducer producer,
+    gchar * path, GString * data, gboolean append)
+{
+  NvDsKittiRecord record;
+
+  record.path = path;
+  record.len = data->len;
+  record.data = g_string_free (data, FALSE);
+  record.append = append;
+
+  if (!spsc_ring_push (&writer->rings[producer], &record)) {
+    kitti_record_clear (&record);
+    g_atomic_int_inc (&writer->dropped);
+    return FALSE;
+  }
+
+  /* Pairs with the fence in the writer: either it sees the new record
+   * before sleeping or we see it waiting. */
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  if (g_atomic_int_get (&writer->waiting)) {
+    g_mutex_lock (&writer->lock);
+    g_cond_signal (&writer->cond);
+    g_mutex_unlock (&writer->lock);
+  }
+  return TRUE;
+}
+
+void
+kitti_writer_get_stats (NvDsKittiWriter * writer, guint * queued,
+    guint * dropped)
+{
+  guint i;
+
+  *queued = 0;
+  for (i = 0; i < KITTI_WRITER_NUM_PRODUCERS; i++)
+    *queued += spsc_ring_count (&writer->rings[i]);
+  *dropped = g_atomic_int_get (&writer->dropped);
+}
+
+void
+kitti_writer_free (NvDsKittiWriter * writer)
+{
+  guint i;
+
+  if (!writer)
+    return;
+
+  g_mutex_lock (&writer->lock);
+  g_atomic_int_set (&writer->stop, 1);
+  g_cond_signal (&writer->cond);
+  g_mutex_unlock (&writer->lock);
+  g_thread_join (writer->thread);
+
+  if (writer->dropped)
+    NVGSTDS_WARN_MSG_V ("%d kitti records dropped, writer fell behind",
+        writer->dropped);
+  if (writer->failed)
+    NVGSTDS_WARN_MSG_V ("%u kitti records could not be written",
+        writer->failed);
+
+  for (i = 0; i < KITTI_WRITER_NUM_PRODUCERS; i++)
+    spsc_ring_deinit (&writer->rings[i]);
+  g_mutex_clear (&writer->lock);
+  g_cond_clear (&writer->cond);
+  g_hash_table_destroy (writer->failed_paths);
+  g_free (writer);
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_KITTI_WRITER_H__
+#define __NVGSTDS_APP_KITTI_WRITER_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+
+/** Number of files each producer may queue ahead of the writer. */
+#define KITTI_WRITER_RING_SIZE 1024
+
+/** Each producing pad probe gets its own queue. */
+typedef enum
+{
+  KITTI_WRITER_GIE,
+  KITTI_WRITER_TRACK,
+  KITTI_WRITER_NUM_PRODUCERS
+} NvDsKittiWriterProducer;
+
+typedef struct _NvDsKittiWriter NvDsKittiWriter;
+
+/**
+ * Start the writer thread.
+ *
+ * @param[in] sync flush written files to disk with one syncfs() per batch.
+ *
+ * @return the writer or NULL on failure.
+ */
+NvDsKittiWriter *kitti_writer_new (gboolean sync);
+
+/**
+ * Queue the contents of one file. Never blocks; the record is dropped and
+ * counted if the writer fell behind. Takes ownership of @p path and
+ * @p data in any case. Only one thread may push per producer.
+ *
+ * @param[in] writer writer of the instance.
+ * @param[in] producer queue of the calling pad probe.
+ * @param[in] path file to write.
+ * @param[in] data preformatted file contents.
+ * @param[in] append append to the file instead of replacing it. If an
+ *            append fails, the file is cut back to its previous end and
+ *            later appends to it are dropped until it is replaced.
+ *
+ * @return FALSE if the record was dropped.
+ */
+gboolean kitti_writer_push (NvDsKittiWriter * writer,
+    NvDsKittiWriterProducer producer, gchar * path, GString * data,
+    gboolean append);
+
+/** Records waiting for the writer and dropped so far, from any thread. */
+void kitti_writer_get_stats (NvDsKittiWriter * writer, guint * queued,
+    guint * dropped);
+
+/** Write out everything queued, stop the thread and release the writer. */
+void kitti_writer_free (NvDsKittiWriter * writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
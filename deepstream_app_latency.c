@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_common.h"
+#include "deepstream_app_latency.h"
+
+typedef struct
+{
+  guint64 buckets[LATENCY_BUCKETS];
+  guint64 sum_us;
+  guint64 max_us;
+  guint64 last_us;
+} NvDsLatencyHistogram;
+
+typedef struct
+{
+  /** Frame number + 1, 0 while the time is being written. */
+  guint64 frame_tag;
+  gint64 time_us;
+} NvDsLatencyStamp;
+
+/** State of one stream, allocated when its first sample arrives. */
+typedef struct
+{
+  /** num_components histograms, written by the probes. */
+  NvDsLatencyHistogram *histograms;
+  /** Bucket counts at the previous report, only used by the thread. */
+  guint64 (*reported)[LATENCY_BUCKETS];
+  /** Stage stamps of the last LATENCY_STAGE_FRAMES frames. */
+  NvDsLatencyStamp stamps[LATENCY_STAGE_FRAMES * LATENCY_MAX_STAGES];
+} NvDsLatencyStream;
+
+struct _NvDsLatencyReporter
+{
+  /** Indexed by source id, published once and kept until the reporter is
+   * freed so sources added at runtime never move another stream's state. */
+  NvDsLatencyStream **streams;
+  gchar **components;
+  guint max_streams;
+  guint num_components;
+  guint interval_sec;
+  guint instance;
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  gint stop;
+};
+
+static guint
+latency_bucket (guint64 us)
+{
+  guint exponent;
+
+  if (us < LATENCY_SUB_BUCKETS)
+    return us;
+  if (us >= (G_GUINT64_CONSTANT (1) << LATENCY_MAX_EXPONENT))
+    return LATENCY_BUCKETS - 1;
+
+  exponent = 63 - __builtin_clzll (us);
+  return (exponent - 3) * LATENCY_SUB_BUCKETS +
+      ((us >> (exponent - 4)) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+/** Middle of a bucket, in ms. */
+static gdouble
+latency_bucket_value (guint bucket)
+{
+  guint exponent, sub;
+
+  if (bucket < LATENCY_SUB_BUCKETS)
+    return bucket / 1000.0;
+
+  exponent = bucket / LATENCY_SUB_BUCKETS + 3;
+  sub = bucket % LATENCY_SUB_BUCKETS;
+  return (((guint64) (LATENCY_SUB_BUCKETS + sub) << (exponent - 4)) +
+      ((G_GUINT64_CONSTANT (1) << (exponent - 4)) / 2.0)) / 1000.0;
+}
+
+static void
+latency_stream_free (NvDsLatencyStream * stream)
+{
+  if (!stream)
+    return;
+  g_free (stream->reported);
+  g_free (stream->histograms);
+  g_free (stream);
+}
+
+/** @return state of a stream, allocated on first use if @p create. */
+static NvDsLatencyStream *
+latency_stream_get (NvDsLatencyReporter * reporter, guint stream_id,
+    gboolean create)
+{
+  NvDsLatencyStream *stream, *expected = NULL;
+
+  if (!reporter || stream_id >= reporter->max_streams)
+    return NULL;
+
+  stream = __atomic_load_n (&reporter->streams[stream_id], __ATOMIC_ACQUIRE);
+  if (stream || !create)
+    return stream;
+
+  stream = g_new0 (NvDsLatencyStream, 1);
+  stream->histograms =
+      g_new0 (NvDsLatencyHistogram, reporter->num_components);
+  stream->reported = g_malloc0 (sizeof (*stream->reported) *
+      reporter->num_components);
+
+  /* Probes of the same source on different threads may race here. */
+  if (!__atomic_compare_exchange_n (&reporter->streams[stream_id], &expected,
+          stream, FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    latency_stream_free (stream);
+    stream = expected;
+  }
+  return stream;
+}
+
+void
+latency_reporter_add (NvDsLatencyReporter * reporter, guint stream_id,
+    guint component, gdouble latency_ms)
+{
+  NvDsLatencyStream *stream;
+  NvDsLatencyHistogram *histogram;
+  guint64 us, max;
+
+  if (!reporter || component >= reporter->num_components)
+    return;
+  stream = latency_stream_get (reporter, stream_id, TRUE);
+  if (!stream)
+    return;
+
+  histogram = &stream->histograms[component];
+  us = latency_ms > 0 ? (guint64) (latency_ms * 1000.0) : 0;
+
+  __atomic_fetch_add (&histogram->buckets[latency_bucket (us)], 1,
+      __ATOMIC_RELAXED);
+  __atomic_fetch_add (&histogram->sum_us, us, __ATOMIC_RELAXED);
+  __atomic_store_n (&histogram->last_us, us, __ATOMIC_RELAXED);
+  max = __atomic_load_n (&histogram->max_us, __ATOMIC_RELAXED);
+  while (us > max && !__atomic_compare_exchange_n (&histogram->max_us, &max,
+          us, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+gdouble
+latency_reporter_last (NvDsLatencyReporter * reporter, guint stream_id,
+    guint component)
+{
+  NvDsLatencyStream *stream = latency_stream_get (reporter, stream_id, FALSE);
+
+  if (!stream || component >= reporter->num_components)
+    return 0;
+
+  return __atomic_load_n (&stream->histograms[component].last_us,
+      __ATOMIC_RELAXED) / 1000.0;
+}
+
+void
+latency_reporter_stamp (NvDsLatencyReporter * reporter, guint stream_id,
+    guint64 frame_num, guint stage, guint component)
+{
+  NvDsLatencyStream *stream;
+  NvDsLatencyStamp *stamps;
+  guint64 tag = frame_num + 1;
+  gint64 now;
+
+  if (stage >= LATENCY_MAX_STAGES)
+    return;
+  stream = latency_stream_get (reporter, stream_id, TRUE);
+  if (!stream)
+    return;
+
+  now = g_get_monotonic_time ();
+  stamps = &stream->stamps[(frame_num % LATENCY_STAGE_FRAMES) *
+      LATENCY_MAX_STAGES];
+
+  __atomic_store_n (&stamps[stage].frame_tag, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+  __atomic_store_n (&stamps[stage].time_us, now, __ATOMIC_RELAXED);
+  __atomic_store_n (&stamps[stage].frame_tag, tag, __ATOMIC_RELEASE);
+
+  /* Earlier stages are stamped by other threads; skip those that have not
+   * seen this frame or are rewriting their stamp. */
+  while (stage-- > 0) {
+    gint64 then;
+
+    if (__atomic_load_n (&stamps[stage].frame_tag, __ATOMIC_ACQUIRE) != tag)
+      continue;
+    then = __atomic_load_n (&stamps[stage].time_us, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_ACQUIRE);
+    if (__atomic_load_n (&stamps[stage].frame_tag, __ATOMIC_RELAXED) != tag)
+      continue;
+
+    latency_reporter_add (reporter, stream_id, component,
+        (now - then) / 1000.0);
+    break;
+  }
+}
+
+gdouble
+latency_counts_percentile (const guint64 * counts, guint64 total,
+    gdouble fraction)
+{
+  guint64 rank = (guint64) (fraction * total + 0.5);
+  guint64 seen = 0;
+  guint i;
+
+  if (rank == 0)
+    rank = 1;
+  for (i = 0; i < LATENCY_BUCKETS; i++) {
+    seen += counts[i];
+    if (seen >= rank)
+      return latency_bucket_value (i);
+  }
+  return latency_bucket_value (LATENCY_BUCKETS - 1);
+}
+
+gboolean
+latency_reporter_summary (NvDsLatencyReporter * reporter, guint stream_id,
+    guint component, NvDsLatencySummary * summary)
+{
+  NvDsLatencyStream *stream = latency_stream_get (reporter, stream_id, FALSE);
+  guint64 counts[LATENCY_BUCKETS];
+  guint i;
+
+  if (!stream || component >= reporter->num_components)
+    return FALSE;
+
+  summary->count = 0;
+  for (i = 0; i < LATENCY_BUCKETS; i++) {
+    counts[i] = __atomic_load_n (&stream->histograms[component].buckets[i],
+        __ATOMIC_RELAXED);
+    summary->count += counts[i];
+  }
+  if (!summary->count)
+    return FALSE;
+
+  summary->sum_ms = __atomic_load_n (&stream->histograms[component].sum_us,
+      __ATOMIC_RELAXED) / 1000.0;
+  summary->p50_ms = latency_counts_percentile (counts, summary->count, 0.50);
+  summary->p90_ms = latency_counts_percentile (counts, summary->count, 0.90);
+  summary->p99_ms = latency_counts_percentile (counts, summary->count, 0.99);
+  return TRUE;
+}
+
+guint64
+latency_reporter_merge (NvDsLatencyReporter * reporter, guint component,
+    guint64 * counts)
+{
+  guint64 total = 0;
+  guint s, i;
+
+  if (!reporter || component >= reporter->num_components)
+    return 0;
+
+  for (s = 0; s < reporter->max_streams; s++) {
+    NvDsLatencyStream *stream = latency_stream_get (reporter, s, FALSE);
+
+    if (!stream)
+      continue;
+    for (i = 0; i < LATENCY_BUCKETS; i++) {
+      guint64 count =
+          __atomic_load_n (&stream->histograms[component].buckets[i],
+          __ATOMIC_RELAXED);
+      counts[i] += count;
+      total += count;
+    }
+  }
+  return total;
+}
+
+/** Print what was recorded since the previous report. */
+static void
+latency_report (NvDsLatencyReporter * reporter)
+{
+  guint64 counts[LATENCY_BUCKETS];
+  GString *report = g_string_new (NULL);
+  guint s, c, i;
+
+  for (s = 0; s < reporter->max_streams; s++) {
+    NvDsLatencyStream *stream = latency_stream_get (reporter, s, FALSE);
+
+    if (!stream)
+      continue;
+
+    for (c = 0; c < reporter->num_components; c++) {
+      NvDsLatencyHistogram *histogram = &stream->histograms[c];
+      guint64 total = 0, max_us;
+
+      for (i = 0; i < LATENCY_BUCKETS; i++) {
+        guint64 count =
+            __atomic_load_n (&histogram->buckets[i], __ATOMIC_RELAXED);
+        counts[i] = count - stream->reported[c][i];
+        stream->reported[c][i] = count;
+        total += counts[i];
+      }
+      max_us = __atomic_exchange_n (&histogram->max_us, 0, __ATOMIC_RELAXED);
+      if (!total)
+        continue;
+
+      g_string_append_printf (report,
+          "%-8u %-8u %-16s %10" G_GUINT64_FORMAT
+          " %10.2f %10.2f %10.2f %10.2f\n", reporter->instance, s,
+          reporter->components[c], total,
+          latency_counts_percentile (counts, total, 0.50),
+          latency_counts_percentile (counts, total, 0.90),
+          latency_counts_percentile (counts, total, 0.99), max_us / 1000.0);
+    }
+  }
+
+  if (report->len)
+    g_print ("\n%-8s %-8s %-16s %10s %10s %10s %10s %10s\n%s", "INSTANCE",
+        "SOURCE", "COMPONENT", "FRAMES", "P50(ms)", "P90(ms)", "P99(ms)",
+        "MAX(ms)", report->str);
+  g_string_free (report, TRUE);
+}
+
+static gpointer
+latency_thread_func (gpointer data)
+{
+  NvDsLatencyReporter *reporter = (NvDsLatencyReporter *) data;
+  gint64 next_report =
+      g_get_monotonic_time () + reporter->interval_sec * G_TIME_SPAN_SECOND;
+
+  g_mutex_lock (&reporter->lock);
+  while (!g_atomic_int_get (&reporter->stop)) {
+    if (g_cond_wait_until (&reporter->cond, &reporter->lock, next_report)
+        || g_atomic_int_get (&reporter->stop))
+      continue;
+
+    g_mutex_unlock (&reporter->lock);
+    latency_report (reporter);
+    next_report += reporter->interval_sec * G_TIME_SPAN_SECOND;
+    g_mutex_lock (&reporter->lock);
+  }
+  g_mutex_unlock (&reporter->lock);
+  return NULL;
+}
+
+NvDsLatencyReporter *
+latency_reporter_new (guint max_streams, const gchar * const *components,
+    guint num_components, guint interval_sec, guint instance)
+{
+  NvDsLatencyReporter *reporter = g_new0 (NvDsLatencyReporter, 1);
+  guint i;
+
+  reporter->max_streams = max_streams;
+  reporter->num_components = num_components;
+  reporter->interval_sec = interval_sec;
+  reporter->instance = instance;
+  reporter->streams = g_new0 (NvDsLatencyStream *, max_streams);
+  reporter->components = g_new0 (gchar *, num_components + 1);
+  for (i = 0; i < num_components; i++)
+    reporter->components[i] = g_strdup (components[i]);
+
+  g_mutex_init (&reporter->lock);
+  g_cond_init (&reporter->cond);
+  if (interval_sec)
+    reporter->thread = g_thread_new ("nvds-latency-report",
+        latency_thread_func, reporter);
+  return reporter;
+}
+
+void
+latency_reporter_free (NvDsLatencyReporter * reporter)
+{
+  guint i;
+
+  if (!reporter)
+    return;
+
+  if (reporter->thread) {
+    g_mutex_lock (&reporter->lock);
+    g_atomic_int_set (&reporter->stop, 1);
+    g_cond_signal (&reporter->cond);
+    g_mutex_unlock (&reporter->lock);
+    g_thread_join (reporter->thread);
+  }
+
+  g_mutex_clear (&reporter->lock);
+  g_cond_clear (&reporter->cond);
+  g_strfreev (reporter->components);
+  for (i = 0; i < reporter->max_streams; i++)
+    latency_stream_free (reporter->streams[i]);
+  g_free (reporter->streams);
+  g_free (reporter);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_LATENCY_H__
+#define __NVGSTDS_APP_LATENCY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+
+/**
+ * Log scale latency buckets in microseconds: exact below 16 us, then 16
+ * sub-buckets per power of two, about 6% resolution up to 2^40 us.
+ */
+#define LATENCY_SUB_BUCKETS 16
+#define LATENCY_MAX_EXPONENT 40
+#define LATENCY_BUCKETS ((LATENCY_MAX_EXPONENT - 3) * LATENCY_SUB_BUCKETS)
+
+/** Probe points a frame can be stamped at, see latency_reporter_stamp(). */
+#define LATENCY_MAX_STAGES 8
+/** Recent frames per stream whose stage stamps are kept. */
+#define LATENCY_STAGE_FRAMES 64
+
+typedef struct _NvDsLatencyReporter NvDsLatencyReporter;
+
+/** Samples of a stream and component since the reporter was created. */
+typedef struct
+{
+  guint64 count;
+  gdouble sum_ms;
+  gdouble p50_ms;
+  gdouble p90_ms;
+  gdouble p99_ms;
+} NvDsLatencySummary;
+
+/**
+ * Start a reporter printing p50/p90/p99/max per stream and component of
+ * the samples received in each interval, from its own thread.
+ *
+ * @param[in] max_streams bound on the source ids; the state of a source is
+ *            only allocated when its first sample arrives.
+ * @param[in] components names of the measured components, the index into
+ *            it is the component passed to latency_reporter_add().
+ * @param[in] interval_sec report period, 0 to only keep histograms.
+ */
+NvDsLatencyReporter *latency_reporter_new (guint max_streams,
+    const gchar * const *components, guint num_components,
+    guint interval_sec, guint instance);
+
+void latency_reporter_free (NvDsLatencyReporter * reporter);
+
+/** Record a sample, from any streaming thread, without blocking. */
+void latency_reporter_add (NvDsLatencyReporter * reporter, guint stream_id,
+    guint component, gdouble latency_ms);
+
+/**
+ * Stamp a frame passing a probe point, from the streaming thread of that
+ * point. The time since the closest earlier stage the same frame was
+ * stamped at is recorded as a sample of @p component.
+ *
+ * @param[in] stage index of the probe point, in pipeline order.
+ */
+void latency_reporter_stamp (NvDsLatencyReporter * reporter, guint stream_id,
+    guint64 frame_num, guint stage, guint component);
+
+/**
+ * Summarize the histogram of a stream and component, from any thread,
+ * without blocking the streaming threads adding to it.
+ *
+ * @return FALSE if nothing was recorded for them yet.
+ */
+gboolean latency_reporter_summary (NvDsLatencyReporter * reporter,
+    guint stream_id, guint component, NvDsLatencySummary * summary);
+
+/**
+ * Add the histograms of a component of every stream to @p counts, from any
+ * thread. Differences of two calls give the samples in between.
+ *
+ * @param[in,out] counts LATENCY_BUCKETS counters.
+ *
+ * @return number of samples added.
+ */
+guint64 latency_reporter_merge (NvDsLatencyReporter * reporter,
+    guint component, guint64 * counts);
+
+/** @return latency in ms below which @p fraction of @p counts are. */
+gdouble latency_counts_percentile (const guint64 * counts, guint64 total,
+    gdouble fraction);
+
+/** @return last latency recorded for a stream and component, in ms. */
+gdouble latency_reporter_last (NvDsLatencyReporter * reporter,
+    guint stream_id, guint component);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
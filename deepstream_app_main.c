@@ -23,30 +23,22 @@
 #include "deepstream_app.h"
 #include "deepstream_config_file_parser.h"
 #include "nvds_version.h"
+#include <math.h>
 #include <string.h>
 #include <unistd.h>
 #include <termios.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 
-//////////////////////////////////////////////////////////
-//200624_Jinhyun
-//UDP
-#include <stdio.h>
-#include <stdlib.h>
-#include <arpa/inet.h>
-#include <sys/types.h>
-#include <sys/socket.h>
-
-#define UDPSendBufferSize 17
-//////////////////////////////////////////////////////////
-
 #define MAX_INSTANCES 128
 #define APP_TITLE "DeepStream"
 
 #define DEFAULT_X_WINDOW_WIDTH 1920
 #define DEFAULT_X_WINDOW_HEIGHT 1080
 
+/* Period of the perf table when no perf-measurement-interval-sec is set. */
+#define DEFAULT_PERF_REPORT_SEC 5
+
 AppCtx* appCtx[MAX_INSTANCES];
 static guint cintr = FALSE;
 static GMainLoop* main_loop = NULL;
@@ -59,10 +51,8 @@ static gboolean quit = FALSE;
 static gint return_value = 0;
 static guint num_instances;
 static guint num_input_files;
-static GMutex fps_lock;
-static gdouble fps[MAX_SOURCE_BINS];
-static gdouble fps_avg[MAX_SOURCE_BINS];
-static guint num_fps_inst = 0;
+static gchar* metrics_address = NULL;
+static NvDsMetrics* metrics = NULL;
 
 static Display* display = NULL;
 static Window windows[MAX_INSTANCES] = { 0 };
@@ -72,38 +62,6 @@ static gint source_ids[MAX_INSTANCES];
 static GThread* x_event_thread = NULL;
 static GMutex disp_lock;
 
-////////////////////////////////////////////////////////////
-//200726_Jinhyun
-int com_period = 40;       // ms
-
-//UDP global variable
-int hClientSock;
-
-char* MissonIP = "127.0.0.1";
-int SendPort = 44666;
-
-char UDP_Xavier_send[UDPSendBufferSize];
-
-struct sockaddr_in clientAddr;
-
-//200819_Jinhyun
-//Tracking output
-int Loss_count;
-
-tracked_data tracking_output;
-extern tracked_data tracking_output;
-
-struct Tracker_output
-{
-    float Centerpoint_X;
-    float Centerpoint_Y;
-    float Box_width;
-    float Box_height;
-    char detect_flag;
-}Tracker_output;
-
-/////////////////////////////////////////////////////////////
-
 GST_DEBUG_CATEGORY(NVDS_APP);
 
 GOptionEntry entries[] = {
@@ -122,6 +80,10 @@ GOptionEntry entries[] = {
   {"input-file", 'i', 0, G_OPTION_ARG_FILENAME_ARRAY, &input_files,
       "Set the input file", NULL}
   ,
+  {"metrics", 'm', 0, G_OPTION_ARG_STRING, &metrics_address,
+      "Serve metrics in Prometheus text format instead of printing them",
+      "[HOST:]PORT|unix:PATH"}
+  ,
   {NULL}
   ,
 };
@@ -129,8 +91,11 @@ GOptionEntry entries[] = {
 /**
  * Callback function to be called once all inferences (Primary + Secondary)
  * are done. This is opportunity to modify content of the metadata.
- * e.g. Here Person is being replaced with Man/Woman and corresponding counts
- * are being maintained. It should be modified according to network classes
+ * e.g. Here objects of the primary GIE are counted per class and the
+ * results of the classifiers attached to them (e.g. Man/Woman of a gender
+ * classifier) per label id, into per stream counters exported as metrics,
+ * and per frame class counts into the count-shm-name
+ * shared memory. It should be modified according to network classes
  * or can be removed altogether if not required.
  */
 
@@ -138,38 +103,41 @@ static void
 all_bbox_generated(AppCtx* appCtx, GstBuffer* buf,
     NvDsBatchMeta* batch_meta, guint index)
 {
-    guint num_male = 0;
-    guint num_female = 0;
-    guint num_objects[128];
-
-    memset(num_objects, 0, sizeof(num_objects));
-
     for (NvDsMetaList* l_frame = batch_meta->frame_meta_list; l_frame != NULL;
         l_frame = l_frame->next) {
         NvDsFrameMeta* frame_meta = l_frame->data;
+        NvDsStatsCounts* counts =
+            app_stats_begin_frame(appCtx->stats, frame_meta->source_id);
+        guint32* frame_counts =
+            count_shm_begin_frame(appCtx->count_shm, frame_meta->source_id);
+        if (!counts)
+            continue;
+
         for (NvDsMetaList* l_obj = frame_meta->obj_meta_list; l_obj != NULL;
             l_obj = l_obj->next) {
             NvDsObjectMeta* obj = (NvDsObjectMeta*)l_obj->data;
-            if (obj->unique_component_id ==
-                (gint)appCtx->config.primary_gie_config.unique_id) {
-                if (obj->class_id >= 0 && obj->class_id < 128) {
-                    num_objects[obj->class_id]++;
-                }
-                if (appCtx->person_class_id > -1
-                    && obj->class_id == appCtx->person_class_id) {
-                    if (strstr(obj->text_params.display_text, "Man")) {
-                        str_replace(obj->text_params.display_text, "Man", "");
-                        str_replace(obj->text_params.display_text, "Person", "Man");
-                        num_male++;
-                    }
-                    else if (strstr(obj->text_params.display_text, "Woman")) {
-                        str_replace(obj->text_params.display_text, "Woman", "");
-                        str_replace(obj->text_params.display_text, "Person", "Woman");
-                        num_female++;
-                    }
+            if (obj->unique_component_id !=
+                (gint)appCtx->config.primary_gie_config.unique_id)
+                continue;
+
+            app_stats_count_object(counts, obj->class_id);
+            count_shm_count_object(frame_counts, obj->class_id);
+            for (NvDsMetaList* l_class = obj->classifier_meta_list;
+                l_class != NULL; l_class = l_class->next) {
+                NvDsClassifierMeta* cmeta = (NvDsClassifierMeta*)l_class->data;
+                guint rank =
+                    get_classifier_rank(appCtx, cmeta->unique_component_id);
+                for (NvDsMetaList* l_label = cmeta->label_info_list;
+                    l_label != NULL; l_label = l_label->next) {
+                    NvDsLabelInfo* label = (NvDsLabelInfo*)l_label->data;
+                    app_stats_count_attribute(counts, rank,
+                        label->result_class_id);
                 }
             }
         }
+        app_stats_end_frame(appCtx->stats, frame_meta->source_id);
+        count_shm_end_frame(appCtx->count_shm, frame_meta->source_id,
+            frame_meta->frame_num);
     }
 }
 
@@ -193,51 +161,236 @@ _intr_handler(int signum)
 }
 
 /**
- * callback function to print the performance numbers of each stream.
+ * Append the metrics of an instance: fps, latency summaries, frame and QoS
+ * counts per source, object and classifier result counts per stream, queue
+ * depths and drop counts. Called from the metrics server thread; only reads
+ * counters the streaming threads update without a lock.
  */
 static void
-perf_cb(gpointer context, NvDsAppPerfStruct* str)
+collect_instance_metrics(NvDsMetricsWriter* writer, gpointer data)
 {
-    static guint header_print_cnt = 0;
-    guint i;
-    AppCtx* appCtx = (AppCtx*)context;
-    guint numf = (num_instances == 1) ? str->num_instances : num_instances;
+    static const gchar* latency_help =
+        "Latency since the pipeline started, by component";
+    AppCtx* appCtx = (AppCtx*)data;
+    NvDsPerfSnapshot perf;
+    gchar labels[128];
+    guint i, c, queued, dropped;
+
+    perf_slot_read(&appCtx->perf_slot, &perf);
+    for (i = 0; i < perf.num_streams; i++) {
+        g_snprintf(labels, sizeof(labels), "instance=\"%u\",source=\"%u\"",
+            appCtx->index, i);
+        metrics_writer_add(writer, "deepstream_fps",
+            "Frames per second over the last perf measurement interval",
+            NV_DS_METRIC_GAUGE, NULL, labels, perf.fps[i]);
+        metrics_writer_add(writer, "deepstream_fps_avg",
+            "Frames per second since the pipeline started",
+            NV_DS_METRIC_GAUGE, NULL, labels, perf.fps_avg[i]);
+    }
+
+    for (i = 0; appCtx->latency_reporter && i < MAX_SOURCE_BINS; i++) {
+        for (c = 0; c < NV_DS_LATENCY_NUM_COMPONENTS; c++) {
+            NvDsLatencySummary summary;
+            const gdouble quantiles[] = { 0.5, 0.9, 0.99 };
+            gdouble values[3];
+            guint q;
+
+            if (!latency_reporter_summary(appCtx->latency_reporter, i, c,
+                    &summary))
+                continue;
 
-    g_mutex_lock(&fps_lock);
-    if (num_instances > 1) {
-        fps[appCtx->index] = str->fps[0];
-        fps_avg[appCtx->index] = str->fps_avg[0];
+            values[0] = summary.p50_ms;
+            values[1] = summary.p90_ms;
+            values[2] = summary.p99_ms;
+            for (q = 0; q < G_N_ELEMENTS(quantiles); q++) {
+                g_snprintf(labels, sizeof(labels),
+                    "instance=\"%u\",source=\"%u\",component=\"%s\","
+                    "quantile=\"%g\"", appCtx->index, i,
+                    latency_component_names[c], quantiles[q]);
+                metrics_writer_add(writer, "deepstream_latency_seconds",
+                    latency_help, NV_DS_METRIC_SUMMARY, NULL, labels,
+                    values[q] / 1000.0);
+            }
+            g_snprintf(labels, sizeof(labels),
+                "instance=\"%u\",source=\"%u\",component=\"%s\"",
+                appCtx->index, i, latency_component_names[c]);
+            metrics_writer_add(writer, "deepstream_latency_seconds",
+                latency_help, NV_DS_METRIC_SUMMARY, "_sum", labels,
+                summary.sum_ms / 1000.0);
+            metrics_writer_add(writer, "deepstream_latency_seconds",
+                latency_help, NV_DS_METRIC_SUMMARY, "_count", labels,
+                summary.count);
+        }
     }
-    else {
-        for (i = 0; i < numf; i++) {
-            fps[i] = str->fps[i];
-            fps_avg[i] = str->fps_avg[i];
+
+    for (i = 0; appCtx->frame_counts && i <= FRAME_COUNTS_OUTPUT; i++) {
+        static const struct
+        {
+            const gchar* name;
+            const gchar* help;
+        } frame_metrics[NV_DS_FRAMES_NUM_COUNTERS] = {
+            { "deepstream_frames_decoded_total",
+                "Frames the source delivered to the muxer" },
+            { "deepstream_frames_muxed_total",
+                "Frames the muxer put into a batch" },
+            { "deepstream_frames_inferred_total",
+                "Frames the primary GIE ran inference on" },
+            { "deepstream_frames_roi_total",
+                "Frames inferred on a window around the followed target" },
+            { "deepstream_frames_qos_dropped_total",
+                "Frames dropped for QoS" },
+            { "deepstream_frames_late_total",
+                "QoS events of frames late for their deadline" },
+        };
+        NvDsSourceFrameCounts* source =
+            frame_counts_source(appCtx->frame_counts, i);
+        guint64 counts[NV_DS_FRAMES_NUM_COUNTERS];
+        gboolean seen = FALSE;
+
+        for (c = 0; c < NV_DS_FRAMES_NUM_COUNTERS; c++) {
+            counts[c] = frame_counts_get(source, c);
+            seen |= counts[c] != 0;
         }
+        if (!seen)
+            continue;
+
+        if (i == FRAME_COUNTS_OUTPUT)
+            g_snprintf(labels, sizeof(labels),
+                "instance=\"%u\",source=\"output\"", appCtx->index);
+        else
+            g_snprintf(labels, sizeof(labels),
+                "instance=\"%u\",source=\"%u\"", appCtx->index, i);
+        for (c = 0; c < NV_DS_FRAMES_NUM_COUNTERS; c++)
+            metrics_writer_add(writer, frame_metrics[c].name,
+                frame_metrics[c].help, NV_DS_METRIC_COUNTER, NULL, labels,
+                counts[c]);
     }
 
-    num_fps_inst++;
-    if (num_fps_inst < num_instances) {
-        g_mutex_unlock(&fps_lock);
-        return;
+    for (i = 0; appCtx->stats && i < appCtx->config.num_source_sub_bins; i++) {
+        NvDsStreamStats stats;
+        guint r;
+
+        if (!app_stats_get(appCtx->stats, i, &stats) || !stats.total.frames)
+            continue;
+
+        for (c = 0; c < STATS_MAX_CLASSES; c++) {
+            if (!stats.total.objects[c])
+                continue;
+            g_snprintf(labels, sizeof(labels),
+                "instance=\"%u\",source=\"%u\",class=\"%u\"",
+                appCtx->index, i, c);
+            metrics_writer_add(writer, "deepstream_objects_total",
+                "Objects of the primary GIE, by class id",
+                NV_DS_METRIC_COUNTER, NULL, labels, stats.total.objects[c]);
+        }
+
+        for (c = 0; c < STATS_MAX_CLASSIFIERS; c++) {
+            for (r = 0; r < STATS_MAX_RESULT_CLASSES; r++) {
+                if (!stats.total.attributes[c][r])
+                    continue;
+                g_snprintf(labels, sizeof(labels),
+                    "instance=\"%u\",source=\"%u\",classifier=\"%u\","
+                    "result=\"%u\"", appCtx->index, i, c, r);
+                metrics_writer_add(writer,
+                    "deepstream_classifier_results_total",
+                    "Classifier results of primary GIE objects, by classifier "
+                    "rank and result class id",
+                    NV_DS_METRIC_COUNTER, NULL, labels,
+                    stats.total.attributes[c][r]);
+            }
+        }
+    }
+
+    if (appCtx->interval_ctl_timer) {
+        g_snprintf(labels, sizeof(labels), "instance=\"%u\"",
+            appCtx->index);
+        metrics_writer_add(writer, "deepstream_pgie_interval",
+            "Batches the primary GIE currently skips between inferences",
+            NV_DS_METRIC_GAUGE, NULL, labels,
+            interval_ctl_interval(&appCtx->interval_ctl));
+    }
+
+    for (i = 0; i < appCtx->num_telemetry_ctx; i++) {
+        telemetry_get_stats(appCtx->telemetry_ctx[i], &queued, &dropped);
+        g_snprintf(labels, sizeof(labels),
+            "instance=\"%u\",destination=\"%u\"", appCtx->index, i);
+        metrics_writer_add(writer, "deepstream_telemetry_queue_depth",
+            "Telemetry samples waiting for the sender",
+            NV_DS_METRIC_GAUGE, NULL, labels, queued);
+        metrics_writer_add(writer, "deepstream_telemetry_dropped_total",
+            "Telemetry samples dropped because the sender fell behind",
+            NV_DS_METRIC_COUNTER, NULL, labels, dropped);
     }
 
-    num_fps_inst = 0;
+    if (appCtx->kitti_writer) {
+        kitti_writer_get_stats(appCtx->kitti_writer, &queued, &dropped);
+        g_snprintf(labels, sizeof(labels), "instance=\"%u\"",
+            appCtx->index);
+        metrics_writer_add(writer, "deepstream_kitti_queue_depth",
+            "KITTI records waiting for the writer",
+            NV_DS_METRIC_GAUGE, NULL, labels, queued);
+        metrics_writer_add(writer, "deepstream_kitti_dropped_total",
+            "KITTI records dropped because the writer fell behind",
+            NV_DS_METRIC_COUNTER, NULL, labels, dropped);
+    }
+}
+
+/**
+ * callback function to publish the performance numbers of each stream.
+ * Each instance only writes its own slot; the perf table and the metrics
+ * server read them on their own schedule.
+ */
+static void
+perf_cb(gpointer context, NvDsAppPerfStruct* str)
+{
+    AppCtx* appCtx = (AppCtx*)context;
 
-    if (header_print_cnt % 20 == 0) {
-        g_print("\n**PERF: ");
-        for (i = 0; i < numf; i++) {
-            g_print("FPS %d (Avg)\t", i);
+    perf_slot_publish(&appCtx->perf_slot, str);
+}
+
+/**
+ * Print the performance numbers of every stream of every instance, when
+ * any instance published new ones since the previous table row.
+ */
+static gboolean
+print_perf_table(gpointer data)
+{
+    static guint header_print_cnt = 0;
+    static guint64 printed_updates[MAX_INSTANCES];
+    static NvDsPerfSnapshot perf;
+    GString* header = g_string_new("**PERF: ");
+    GString* row = g_string_new("**PERF: ");
+    gboolean updated = FALSE;
+    guint i, j;
+
+    for (i = 0; i < num_instances; i++) {
+        perf_slot_read(&appCtx[i]->perf_slot, &perf);
+        if (perf.updates != printed_updates[i])
+            updated = TRUE;
+        printed_updates[i] = perf.updates;
+
+        for (j = 0; j < perf.num_streams; j++) {
+            if (num_instances > 1)
+                g_string_append_printf(header, "FPS %u:%u (Avg)\t", i, j);
+            else
+                g_string_append_printf(header, "FPS %u (Avg)\t", j);
+            g_string_append_printf(row, "%.2f (%.2f)\t", perf.fps[j],
+                perf.fps_avg[j]);
         }
-        g_print("\n");
-        header_print_cnt = 0;
     }
-    header_print_cnt++;
-    g_print("**PERF: ");
-    for (i = 0; i < numf; i++) {
-        g_print("%.2f (%.2f)\t", fps[i], fps_avg[i]);
+
+    if (updated) {
+        if (header_print_cnt % 20 == 0) {
+            g_print("\n%s\n", header->str);
+            header_print_cnt = 0;
+        }
+        header_print_cnt++;
+        g_print("%s\n", row->str);
     }
-    g_print("\n");
-    g_mutex_unlock(&fps_lock);
+
+    g_string_free(header, TRUE);
+    g_string_free(row, TRUE);
+    return TRUE;
 }
 
 /**
@@ -330,57 +483,17 @@ print_runtime_commands(void)
 static guint rrow, rcol;
 static gboolean rrowsel = FALSE, selecting = FALSE;
 
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-//200726_JinHyun
-//UDP send | Deepstream -> Missionprogram
-
-void udp_send_initialize()
-{
-    Loss_count = 0;
-    hClientSock = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
-
-    if (hClientSock == -1)
-    {
-        fprintf(stderr, "socket() failed");
-        exit(1);
-    }
-    memset(&UDP_Xavier_send, 0, sizeof(UDP_Xavier_send));
-
-    memset(&clientAddr, 0, sizeof(clientAddr));
-    clientAddr.sin_family = AF_INET;
-    clientAddr.sin_addr.s_addr = inet_addr(MissonIP);           // Local IP
-    clientAddr.sin_port = htons(SendPort);                      // Port Number
-}
-
-gint udp_send(gpointer data)
+/**
+ * Expand a source in the tiled display, -1 to go back to all sources.
+ */
+static void set_show_source(guint index, gint source_id)
 {
-    Tracker_output.Centerpoint_X = tracking_output.centerx;
-    Tracker_output.Centerpoint_Y = tracking_output.centery;
-    Tracker_output.Box_width = tracking_output.width;
-    Tracker_output.Box_height = tracking_output.height;
-    
-    if (tracking_output.detect_flag == 0)                             //Flag :  detect = 1, Loss = 0
-    {
-        Loss_count = Loss_count + 1;
-        if (Loss_count > 1)
-        {
-            Tracker_output.detect_flag = 0;
-        }
-        else
-        {
-            Tracker_output.detect_flag = 1;
-        }
-    }
-    else
-    {
-        Loss_count = 0;
-        Tracker_output.detect_flag = 1;
-    }
-    memcpy(&UDP_Xavier_send, &Tracker_output, sizeof(struct Tracker_output));
+    GstElement* tiler = appCtx[index]->pipeline.tiled_display_bin.tiler;
 
-    sendto(hClientSock, UDP_Xavier_send, UDPSendBufferSize, 0, (struct sockaddr*)&clientAddr, sizeof(clientAddr));
+    g_object_set(G_OBJECT(tiler), "show-source", source_id, NULL);
+    source_ids[index] = source_id;
+    g_atomic_int_set(&appCtx[index]->show_source, source_id);
 }
-//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /**
  * Loop function to check keyboard inputs and status of each pipeline.
@@ -451,9 +564,8 @@ static gboolean event_thread_func(gpointer arg)
                     }
                     else
                     {
-                        source_ids[0] = source_id;
                         appCtx[0]->show_bbox_text = TRUE;
-                        g_object_set(G_OBJECT(tiler), "show-source", source_id, NULL);
+                        set_show_source(0, source_id);
                     }
                 }
                 else
@@ -491,16 +603,16 @@ static gboolean event_thread_func(gpointer arg)
         {
             if (!show_bbox_text)
                 appCtx[0]->show_bbox_text = FALSE;
-            g_object_set(G_OBJECT(tiler), "show-source", -1, NULL);
-            source_ids[0] = -1;
+            set_show_source(0, -1);
             selecting = FALSE;
             g_print("--tiled mode --\n");
         }
         break;
 ///////////////////////////////////////////////////////////////////////////////////////
     case 't':
-        tracking_output.reset_flag = 1;
-        g_print("Reset flag on : %u", tracking_output.reset_flag);
+        for (i = 0; i < num_instances; i++)
+            target_selector_request_reset(&appCtx[i]->target_selector);
+        g_print("Target reset requested\n");
         break;
 ///////////////////////////////////////////////////////////////////////////////////////
     default:
@@ -561,15 +673,13 @@ static gpointer nvds_x_event_thread(gpointer data)
                     source_id = get_source_id_from_coordinates(ev.x * 1.0 / win_attr.width, ev.y * 1.0 / win_attr.height);
                     if (source_id > -1)
                     {
-                        g_object_set(G_OBJECT(tiler), "show-source", source_id, NULL);
-                        source_ids[index] = source_id;
                         appCtx[index]->show_bbox_text = TRUE;
+                        set_show_source(index, source_id);
                     }
                 }
                 else if (ev.button == Button3)
                 {
-                    g_object_set(G_OBJECT(tiler), "show-source", -1, NULL);
-                    source_ids[index] = -1;
+                    set_show_source(index, -1);
                     if (!show_bbox_text)
                         appCtx[index]->show_bbox_text = FALSE;
                 }
@@ -633,44 +743,79 @@ static gpointer nvds_x_event_thread(gpointer data)
  */
 static gboolean overlay_graphics(AppCtx* appCtx, GstBuffer* buf, NvDsBatchMeta* batch_meta, guint index)
 {
-    NvDsFrameLatencyInfo* latency_info = NULL;
     NvDsDisplayMeta *display_meta = nvds_acquire_display_meta_from_pool (batch_meta);
-    display_meta->num_labels = 1;
+    NvDsTargetSet targets;
+    tracked_data tracking_output;
+    NvDsTargetSelector* selector = &appCtx->target_selector;
+    NvDsTiledDisplayConfig* tiled_config = &appCtx->config.tiled_display_config;
+    gint show_source = g_atomic_int_get(&appCtx->show_source);
+    gint stream_id;
+    gfloat scale_x = 1, scale_y = 1;
+    gfloat center_x, center_y, gate_x, gate_y, target_x, target_y;
+
+    /* Targets are published at TARGET_REFERENCE_HEIGHT lines and drawn in
+     * streammux pixels. Behind the tiler the followed target can only be
+     * drawn over an expanded source, scaled to the output; the grid view
+     * gets no crosshair. */
+    if (!tiled_config->enable)
+        stream_id = index;
+    else
+    {
+        stream_id = show_source;
+        if (tiled_config->width && tiled_config->height)
+        {
+            scale_x = (gfloat)tiled_config->width / selector->frame_width;
+            scale_y = (gfloat)tiled_config->height / selector->frame_height;
+        }
+    }
+    center_x = selector->frame_width / 2 * scale_x;
+    center_y = selector->frame_height / 2 * scale_y;
+    gate_x = sqrtf(selector->gate_radius_sq) * selector->frame_height * scale_x;
+    gate_y = sqrtf(selector->gate_radius_sq) * selector->frame_height * scale_y;
+    target_x = selector->frame_height / TARGET_REFERENCE_HEIGHT * scale_x;
+    target_y = selector->frame_height / TARGET_REFERENCE_HEIGHT * scale_y;
+
+    memset(&targets, 0, sizeof(targets));
+    if (stream_id >= 0)
+        target_selector_read(&appCtx->target_selector, stream_id, &targets);
+    tracking_output = targets.targets[0];
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 //  kyungIn 20200909
     NvOSD_LineParams *line_params = display_meta->line_params;
-    line_params[0].x1 = 950+ tracking_output.centerx;//for demonstration, user need to se these values
-    line_params[0].y1 = 540 - tracking_output.centery;
-    line_params[0].x2 = 970+ tracking_output.centerx;;
-    line_params[0].y2 = 540 - tracking_output.centery;
-    line_params[0].line_width = 20;
-    line_params[0].line_color = (NvOSD_ColorParams){1.0, 0.0, 0.0, 1.0};
-    display_meta->num_lines++;
- 
     NvOSD_RectParams *rect_params = display_meta->rect_params;
-    //rect_params[0].left = 960+ tracking_output.centerx - 10;
-    //rect_params[0].top = 540 - tracking_output.cdk tlqentery + 10;
-    //rect_params[0].width = 20;
-    //rect_params[0].height = 20;
-    //rect_params[0].border_width = 3;
-    //rect_params[0].border_color = (NvOSD_ColorParams){0, 1, 0, 1};
-    //display_meta->num_rects++;
-    //if (source_ids[index] == -1)
-    //return TRUE;
-   
-    rect_params[0].left = 960+ tracking_output.centerx - 250;
-    rect_params[0].top = 540 - tracking_output.centery - 250;
-    rect_params[0].width = 500;
-    rect_params[0].height = 500;
-    rect_params[0].border_width = 6;
-    rect_params[0].border_color = (NvOSD_ColorParams){0, 1, 0, 1};
-    display_meta->num_rects++;
+    if (stream_id >= 0)
+    {
+        line_params[0].x1 = center_x - 10 + tracking_output.centerx * target_x;//for demonstration, user need to se these values
+        line_params[0].y1 = center_y - tracking_output.centery * target_y;
+        line_params[0].x2 = center_x + 10 + tracking_output.centerx * target_x;
+        line_params[0].y2 = center_y - tracking_output.centery * target_y;
+        line_params[0].line_width = 20;
+        line_params[0].line_color = (NvOSD_ColorParams){1.0, 0.0, 0.0, 1.0};
+        display_meta->num_lines++;
+
+        //rect_params[0].left = 960+ tracking_output.centerx - 10;
+        //rect_params[0].top = 540 - tracking_output.cdk tlqentery + 10;
+        //rect_params[0].width = 20;
+        //rect_params[0].height = 20;
+        //rect_params[0].border_width = 3;
+        //rect_params[0].border_color = (NvOSD_ColorParams){0, 1, 0, 1};
+        //display_meta->num_rects++;
+        //if (source_ids[index] == -1)
+        //return TRUE;
+
+        //Gate around the followed target
+        rect_params[0].left = center_x + tracking_output.centerx * target_x - gate_x;
+        rect_params[0].top = center_y - tracking_output.centery * target_y - gate_y;
+        rect_params[0].width = 2 * gate_x;
+        rect_params[0].height = 2 * gate_y;
+        rect_params[0].border_width = 6;
+        rect_params[0].border_color = (NvOSD_ColorParams){0, 1, 0, 1};
+        display_meta->num_rects++;
+    }
     
     
-    if (source_ids[index] == -1)
-        return TRUE;
     //  kyungIn 20200819
     //rect_params[0].left = 960 + tracking_output.centerx - 1;
     //rect_params[0].top = 510 - tracking_output.centery + 1;
@@ -686,33 +831,40 @@ static gboolean overlay_graphics(AppCtx* appCtx, GstBuffer* buf, NvDsBatchMeta*
     //NvDsFrameLatencyInfo* latency_info = NULL;
     //NvDsDisplayMeta* display_meta = nvds_acquire_display_meta_from_pool(batch_meta);
 
-    display_meta->num_labels = 1;
-    display_meta->text_params[0].display_text = g_strdup_printf("Source: %s", appCtx->config.multi_source_config[source_ids[index]].uri);
-
-    display_meta->text_params[0].y_offset = 20;
-    display_meta->text_params[0].x_offset = 20;
-    display_meta->text_params[0].font_params.font_color = (NvOSD_ColorParams){ 0, 1, 0, 1 };
-    display_meta->text_params[0].font_params.font_size = appCtx->config.osd_config.text_size * 1.5;
-    display_meta->text_params[0].font_params.font_name = "Serif";
-    display_meta->text_params[0].set_bg_clr = 1;
-    display_meta->text_params[0].text_bg_clr = (NvOSD_ColorParams){ 0, 0, 0, 1.0 };
-
+    /* The grid view has no source label and shows the latency of the first
+     * stream; an expanded source shows its own. */
+    display_meta->num_labels = 0;
+    if (show_source >= 0)
+    {
+        display_meta->num_labels = 1;
+        display_meta->text_params[0].display_text = g_strdup_printf("Source: %s", appCtx->config.multi_source_config[show_source].uri);
+
+        display_meta->text_params[0].y_offset = 20;
+        display_meta->text_params[0].x_offset = 20;
+        display_meta->text_params[0].font_params.font_color = (NvOSD_ColorParams){ 0, 1, 0, 1 };
+        display_meta->text_params[0].font_params.font_size = appCtx->config.osd_config.text_size * 1.5;
+        display_meta->text_params[0].font_params.font_name = "Serif";
+        display_meta->text_params[0].set_bg_clr = 1;
+        display_meta->text_params[0].text_bg_clr = (NvOSD_ColorParams){ 0, 0, 0, 1.0 };
+    }
 
-    if (nvds_enable_latency_measurement)
+    if (appCtx->latency_reporter)
     {
-        g_mutex_lock(&appCtx->latency_lock);
-        latency_info = &appCtx->latency_info[index];
+        NvOSD_TextParams* text = &display_meta->text_params[display_meta->num_labels];
+
+        text->display_text = g_strdup_printf("Latency: %lf",
+            latency_reporter_last(appCtx->latency_reporter,
+                show_source >= 0 ? (guint)show_source : 0,
+                NV_DS_LATENCY_FRAME));
+
+        text->y_offset = 20 + display_meta->num_labels * (20 + appCtx->config.osd_config.text_size * 1.5);
+        text->x_offset = 20;
+        text->font_params.font_color = (NvOSD_ColorParams){ 0, 1, 0, 1 };
+        text->font_params.font_size = appCtx->config.osd_config.text_size * 1.5;
+        text->font_params.font_name = "Arial";
+        text->set_bg_clr = 1;
+        text->text_bg_clr = (NvOSD_ColorParams){ 0, 0, 0, 1.0 };
         display_meta->num_labels++;
-        display_meta->text_params[1].display_text = g_strdup_printf("Latency: %lf", latency_info->latency);
-        g_mutex_unlock(&appCtx->latency_lock);
-
-        display_meta->text_params[1].y_offset = (display_meta->text_params[0].y_offset * 2) + display_meta->text_params[0].font_params.font_size;
-        display_meta->text_params[1].x_offset = 20;
-        display_meta->text_params[1].font_params.font_color = (NvOSD_ColorParams){ 0, 1, 0, 1 };
-        display_meta->text_params[1].font_params.font_size = appCtx->config.osd_config.text_size * 1.5;
-        display_meta->text_params[1].font_params.font_name = "Arial";
-        display_meta->text_params[1].set_bg_clr = 1;
-        display_meta->text_params[1].text_bg_clr = (NvOSD_ColorParams){ 0, 0, 0, 1.0 };
     }
 
     nvds_add_display_meta_to_frame(nvds_get_nth_frame_meta(batch_meta->frame_meta_list, 0), display_meta);
@@ -724,7 +876,7 @@ int main(int argc, char* argv[])
     GOptionContext* ctx = NULL;
     GOptionGroup* group = NULL;
     GError* error = NULL;
-    guint i;
+    guint i, j;
 
     ctx = g_option_context_new("Nvidia DeepStream Demo");
     group = g_option_group_new("abc", NULL, NULL, NULL, NULL);
@@ -777,7 +929,6 @@ int main(int argc, char* argv[])
     for (i = 0; i < num_instances; i++)
     {
         appCtx[i] = g_malloc0(sizeof(AppCtx));
-        appCtx[i]->person_class_id = -1;
         appCtx[i]->car_class_id = -1;
         appCtx[i]->index = i;
         if (show_bbox_text)
@@ -809,6 +960,68 @@ int main(int argc, char* argv[])
         }
     }
 
+    //////////////////////////////////////////////////////////////
+    //200726_Jinhyun
+    //UDP send | Deepstream -> Missionprogram
+    //Without a [telemetry<N>] group the first instance keeps sending to the
+    //default mission program destination.
+    for (i = 0; i < num_instances; i++)
+    {
+        NvDsConfig* config = &appCtx[i]->config;
+
+        if (i == 0 && config->num_telemetry_destinations == 0)
+        {
+            telemetry_config_set_defaults(&config->telemetry_config[0]);
+            config->num_telemetry_destinations = 1;
+        }
+
+        for (j = 0; j < config->num_telemetry_destinations; j++)
+        {
+            NvDsTelemetryCtx* ctx =
+                start_telemetry_sender(&config->telemetry_config[j]);
+            if (!ctx)
+            {
+                NVGSTDS_ERR_MSG_V("Failed to start telemetry sender");
+                return_value = -1;
+                goto done;
+            }
+            appCtx[i]->telemetry_ctx[appCtx[i]->num_telemetry_ctx++] = ctx;
+        }
+    }
+    //////////////////////////////////////////////////////////////
+
+    if (metrics_address)
+    {
+        metrics = metrics_server_start(metrics_address);
+        if (!metrics)
+        {
+            NVGSTDS_ERR_MSG_V("Failed to start metrics server");
+            return_value = -1;
+            goto done;
+        }
+        for (i = 0; i < num_instances; i++)
+            metrics_add_collector(metrics, collect_instance_metrics, appCtx[i]);
+    }
+
+    if (!metrics)
+    {
+        guint perf_interval_sec = 0;
+
+        for (i = 0; i < num_instances; i++)
+        {
+            guint interval = appCtx[i]->config.perf_measurement_interval_sec;
+
+            if (!appCtx[i]->config.enable_perf_measurement)
+                continue;
+            if (!interval)
+                interval = DEFAULT_PERF_REPORT_SEC;
+            if (!perf_interval_sec || interval < perf_interval_sec)
+                perf_interval_sec = interval;
+        }
+        if (perf_interval_sec)
+            g_timeout_add_seconds(perf_interval_sec, print_perf_table, NULL);
+    }
+
     main_loop = g_main_loop_new(NULL, FALSE);
 
     _intr_setup();
@@ -819,8 +1032,6 @@ int main(int argc, char* argv[])
     display = XOpenDisplay(NULL);
     for (i = 0; i < num_instances; i++)
     {
-        guint j;
-
         if (gst_element_set_state(appCtx[i]->pipeline.pipeline, GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE)
         {
             NVGSTDS_ERR_MSG_V("Failed to set pipeline to PAUSED");
@@ -922,16 +1133,6 @@ int main(int argc, char* argv[])
 
     g_timeout_add(40, event_thread_func, NULL);
 
-    //////////////////////////////////////////////////////////////
-    //200726_Jinhyun
-    //UDP send 
-
-    udp_send_initialize();                           //UDP Initialize
-
-    g_timeout_add(com_period, udp_send, NULL);       //UDP Send
-
-    //////////////////////////////////////////////////////////////
-
     g_main_loop_run (main_loop);
 
     changemode(0);
@@ -939,11 +1140,20 @@ int main(int argc, char* argv[])
 done:
 
     g_print("Quitting\n");
+    metrics_server_stop(metrics);
+    metrics = NULL;
     for (i = 0; i < num_instances; i++)
     {
         if (appCtx[i]->return_value == -1)
             return_value = -1;
         destroy_pipeline(appCtx[i]);
+        latency_reporter_free(appCtx[i]->latency_reporter);
+        class_filter_deinit(&appCtx[i]->config.target_class_filter);
+        g_strfreev(appCtx[i]->config.target_classes);
+        for (j = 0; j < appCtx[i]->num_telemetry_ctx; j++)
+            stop_telemetry_sender(appCtx[i]->telemetry_ctx[j]);
+        for (j = 0; j < appCtx[i]->config.num_telemetry_destinations; j++)
+            telemetry_config_clear(&appCtx[i]->config.telemetry_config[j]);
         g_mutex_lock(&disp_lock);
         if (windows[i])
             XDestroyWindow(display, windows[i]);
@@ -0,0 +1,478 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "deepstream_common.h"
+#include "deepstream_app_metrics.h"
+
+/** Push metric, set with metrics_set(). */
+typedef struct
+{
+  gchar *name;
+  gchar *help;
+  NvDsMetricType type;
+  gchar *labels;
+  gdouble value;
+} NvDsMetricValue;
+
+typedef struct
+{
+  NvDsMetricsCollectFunc func;
+  gpointer user_data;
+} NvDsMetricsCollector;
+
+typedef struct
+{
+  gchar *name;
+  gchar *help;
+  NvDsMetricType type;
+  GString *samples;
+} NvDsMetricFamily;
+
+struct _NvDsMetricsWriter
+{
+  /** Families in the order their first sample was added. */
+  GPtrArray *families;
+  GHashTable *by_name;
+};
+
+struct _NvDsMetrics
+{
+  gint sock;
+  /** Socket file removed on stop, NULL for TCP. */
+  gchar *unix_path;
+  /** Written by metrics_server_stop() to wake the server from poll(). */
+  gint wake_fds[2];
+  GThread *thread;
+  gint stop;
+  /** Protects values and collectors; never taken by streaming threads. */
+  GMutex lock;
+  GPtrArray *values;
+  /** "name{labels}" to the entry in values. */
+  GHashTable *value_index;
+  GArray *collectors;
+};
+
+static const gchar *metric_type_names[] = { "gauge", "counter", "summary" };
+
+static void
+metric_family_free (gpointer data)
+{
+  NvDsMetricFamily *family = (NvDsMetricFamily *) data;
+
+  g_free (family->name);
+  g_free (family->help);
+  g_string_free (family->samples, TRUE);
+  g_free (family);
+}
+
+static void
+metric_value_free (gpointer data)
+{
+  NvDsMetricValue *value = (NvDsMetricValue *) data;
+
+  g_free (value->name);
+  g_free (value->help);
+  g_free (value->labels);
+  g_free (value);
+}
+
+void
+metrics_writer_add (NvDsMetricsWriter * writer, const gchar * name,
+    const gchar * help, NvDsMetricType type, const gchar * suffix,
+    const gchar * labels, gdouble value)
+{
+  NvDsMetricFamily *family = g_hash_table_lookup (writer->by_name, name);
+
+  if (!family) {
+    family = g_new0 (NvDsMetricFamily, 1);
+    family->name = g_strdup (name);
+    family->help = g_strdup (help);
+    family->type = type;
+    family->samples = g_string_new (NULL);
+    g_ptr_array_add (writer->families, family);
+    g_hash_table_insert (writer->by_name, family->name, family);
+  }
+
+  g_string_append (family->samples, name);
+  if (suffix)
+    g_string_append (family->samples, suffix);
+  if (labels && *labels)
+    g_string_append_printf (family->samples, "{%s}", labels);
+
+  if (isnan (value))
+    g_string_append (family->samples, " NaN\n");
+  else if (isinf (value))
+    g_string_append (family->samples, value > 0 ? " +Inf\n" : " -Inf\n");
+  else
+    g_string_append_printf (family->samples, " %.10g\n", value);
+}
+
+/** Current value of every metric, in the Prometheus text format. */
+static GString *
+metrics_render (NvDsMetrics * metrics)
+{
+  NvDsMetricsWriter writer;
+  GString *text = g_string_new (NULL);
+  guint i;
+
+  writer.families = g_ptr_array_new_with_free_func (metric_family_free);
+  writer.by_name = g_hash_table_new (g_str_hash, g_str_equal);
+
+  g_mutex_lock (&metrics->lock);
+  for (i = 0; i < metrics->values->len; i++) {
+    NvDsMetricValue *value = g_ptr_array_index (metrics->values, i);
+
+    metrics_writer_add (&writer, value->name, value->help, value->type, NULL,
+        value->labels, value->value);
+  }
+  for (i = 0; i < metrics->collectors->len; i++) {
+    NvDsMetricsCollector *collector =
+        &g_array_index (metrics->collectors, NvDsMetricsCollector, i);
+
+    collector->func (&writer, collector->user_data);
+  }
+  g_mutex_unlock (&metrics->lock);
+
+  for (i = 0; i < writer.families->len; i++) {
+    NvDsMetricFamily *family = g_ptr_array_index (writer.families, i);
+
+    if (family->help)
+      g_string_append_printf (text, "# HELP %s %s\n", family->name,
+          family->help);
+    g_string_append_printf (text, "# TYPE %s %s\n%s", family->name,
+        metric_type_names[family->type], family->samples->str);
+  }
+
+  g_hash_table_destroy (writer.by_name);
+  g_ptr_array_free (writer.families, TRUE);
+  return text;
+}
+
+static gboolean
+metrics_send_all (gint client, const gchar * data, gsize len)
+{
+  while (len) {
+    ssize_t sent = send (client, data, len, MSG_NOSIGNAL);
+
+    if (sent < 0) {
+      if (errno == EINTR)
+        continue;
+      return FALSE;
+    }
+    data += sent;
+    len -= sent;
+  }
+  return TRUE;
+}
+
+/** Answer one request; anything but GET or HEAD of /metrics is refused. */
+static void
+metrics_serve (NvDsMetrics * metrics, gint client)
+{
+  struct timeval timeout = { METRICS_IO_TIMEOUT_MS / 1000,
+    (METRICS_IO_TIMEOUT_MS % 1000) * 1000
+  };
+  gchar request[METRICS_MAX_REQUEST + 1];
+  gsize len = 0;
+  gboolean head;
+  const gchar *path, *status = "200 OK";
+  GString *body = NULL, *response;
+
+  setsockopt (client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+  setsockopt (client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof (timeout));
+
+  while (len < METRICS_MAX_REQUEST) {
+    ssize_t received = recv (client, request + len, METRICS_MAX_REQUEST - len,
+        0);
+
+    if (received < 0 && errno == EINTR)
+      continue;
+    if (received <= 0)
+      return;
+    len += received;
+    request[len] = '\0';
+    if (strstr (request, "\r\n\r\n") || strstr (request, "\n\n"))
+      break;
+  }
+  request[len] = '\0';
+
+  head = g_str_has_prefix (request, "HEAD ");
+  if (!head && !g_str_has_prefix (request, "GET ")) {
+    status = "405 Method Not Allowed";
+  } else {
+    path = request + (head ? 5 : 4);
+    if (!g_str_has_prefix (path, "/metrics ") &&
+        !g_str_has_prefix (path, "/metrics?") && !g_str_has_prefix (path, "/ "))
+      status = "404 Not Found";
+    else
+      body = metrics_render (metrics);
+  }
+
+  response = g_string_new (NULL);
+  g_string_append_printf (response,
+      "HTTP/1.0 %s\r\n"
+      "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+      "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+      "Connection: close\r\n\r\n", status, body ? body->len : 0);
+  if (body && !head)
+    g_string_append_len (response, body->str, body->len);
+
+  metrics_send_all (client, response->str, response->len);
+  g_string_free (response, TRUE);
+  if (body)
+    g_string_free (body, TRUE);
+}
+
+static gpointer
+metrics_thread_func (gpointer data)
+{
+  NvDsMetrics *metrics = (NvDsMetrics *) data;
+  struct pollfd fds[2] = {
+    {metrics->sock, POLLIN, 0},
+    {metrics->wake_fds[0], POLLIN, 0}
+  };
+
+  while (!g_atomic_int_get (&metrics->stop)) {
+    gint client;
+
+    if (poll (fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      NVGSTDS_ERR_MSG_V ("Metrics server poll() failed: %s",
+          g_strerror (errno));
+      break;
+    }
+    if (fds[1].revents)
+      break;
+    if (!(fds[0].revents & POLLIN))
+      continue;
+
+    client = accept4 (metrics->sock, NULL, NULL, SOCK_CLOEXEC);
+    if (client < 0)
+      continue;
+    metrics_serve (metrics, client);
+    close (client);
+  }
+  return NULL;
+}
+
+static gboolean
+metrics_open_socket (NvDsMetrics * metrics, const gchar * address)
+{
+  struct sockaddr_storage addr;
+  struct sockaddr_in *in_addr = (struct sockaddr_in *) &addr;
+  struct sockaddr_un *un_addr = (struct sockaddr_un *) &addr;
+  socklen_t addr_len;
+  gint one = 1;
+
+  memset (&addr, 0, sizeof (addr));
+  if (g_str_has_prefix (address, METRICS_UNIX_PREFIX)) {
+    const gchar *path = address + strlen (METRICS_UNIX_PREFIX);
+
+    if (!*path || strlen (path) >= sizeof (un_addr->sun_path)) {
+      NVGSTDS_ERR_MSG_V ("Invalid metrics socket path '%s'", path);
+      return FALSE;
+    }
+    un_addr->sun_family = AF_UNIX;
+    strcpy (un_addr->sun_path, path);
+    addr_len = sizeof (*un_addr);
+    /* Left behind by a previous run that did not exit cleanly. */
+    unlink (path);
+    metrics->unix_path = g_strdup (path);
+    metrics->sock = socket (PF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  } else {
+    const gchar *colon = strrchr (address, ':');
+    gchar *host = colon ? g_strndup (address, colon - address) :
+        g_strdup (METRICS_DEFAULT_HOST);
+    const gchar *port = colon ? colon + 1 : address;
+    gchar *end = NULL;
+    guint64 port_num = g_ascii_strtoull (port, &end, 10);
+    gboolean valid = *port && !*end && port_num > 0 && port_num <= G_MAXUINT16
+        && inet_aton (host, &in_addr->sin_addr);
+
+    g_free (host);
+    if (!valid) {
+      NVGSTDS_ERR_MSG_V ("Invalid metrics address '%s'", address);
+      return FALSE;
+    }
+    in_addr->sin_family = AF_INET;
+    in_addr->sin_port = htons (port_num);
+    addr_len = sizeof (*in_addr);
+    metrics->sock = socket (PF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (metrics->sock != -1)
+      setsockopt (metrics->sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof (one));
+  }
+
+  if (metrics->sock == -1) {
+    NVGSTDS_ERR_MSG_V ("socket() failed");
+    return FALSE;
+  }
+  if (bind (metrics->sock, (struct sockaddr *) &addr, addr_len) < 0 ||
+      listen (metrics->sock, 8) < 0) {
+    NVGSTDS_ERR_MSG_V ("Failed to listen for metrics on '%s': %s", address,
+        g_strerror (errno));
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static void
+metrics_free (NvDsMetrics * metrics)
+{
+  if (metrics->sock != -1)
+    close (metrics->sock);
+  if (metrics->unix_path) {
+    unlink (metrics->unix_path);
+    g_free (metrics->unix_path);
+  }
+  if (metrics->wake_fds[0] != -1) {
+    close (metrics->wake_fds[0]);
+    close (metrics->wake_fds[1]);
+  }
+  g_mutex_clear (&metrics->lock);
+  g_hash_table_destroy (metrics->value_index);
+  g_ptr_array_free (metrics->values, TRUE);
+  g_array_free (metrics->collectors, TRUE);
+  g_free (metrics);
+}
+
+NvDsMetrics *
+metrics_server_start (const gchar * address)
+{
+  NvDsMetrics *metrics = g_new0 (NvDsMetrics, 1);
+
+  metrics->sock = -1;
+  metrics->wake_fds[0] = metrics->wake_fds[1] = -1;
+  g_mutex_init (&metrics->lock);
+  metrics->values = g_ptr_array_new_with_free_func (metric_value_free);
+  metrics->value_index =
+      g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  metrics->collectors = g_array_new (FALSE, FALSE,
+      sizeof (NvDsMetricsCollector));
+
+  if (!metrics_open_socket (metrics, address))
+    goto error;
+  if (pipe2 (metrics->wake_fds, O_CLOEXEC) < 0) {
+    metrics->wake_fds[0] = metrics->wake_fds[1] = -1;
+    NVGSTDS_ERR_MSG_V ("pipe2() failed");
+    goto error;
+  }
+
+  metrics->thread = g_thread_new ("nvds-metrics-server", metrics_thread_func,
+      metrics);
+  return metrics;
+
+error:
+  metrics_free (metrics);
+  return NULL;
+}
+
+void
+metrics_server_stop (NvDsMetrics * metrics)
+{
+  gchar wake = 0;
+
+  if (!metrics)
+    return;
+
+  g_atomic_int_set (&metrics->stop, 1);
+  if (write (metrics->wake_fds[1], &wake, 1) < 0)
+    NVGSTDS_WARN_MSG_V ("Failed to wake the metrics server");
+  g_thread_join (metrics->thread);
+  metrics_free (metrics);
+}
+
+void
+metrics_set (NvDsMetrics * metrics, const gchar * name, const gchar * help,
+    NvDsMetricType type, const gchar * labels, gdouble value)
+{
+  NvDsMetricValue *entry;
+  gchar *key;
+
+  if (!metrics)
+    return;
+
+  key = g_strdup_printf ("%s{%s}", name, labels ? labels : "");
+  g_mutex_lock (&metrics->lock);
+  entry = g_hash_table_lookup (metrics->value_index, key);
+  if (!entry) {
+    entry = g_new0 (NvDsMetricValue, 1);
+    entry->name = g_strdup (name);
+    entry->help = g_strdup (help);
+    entry->type = type;
+    entry->labels = g_strdup (labels);
+    g_ptr_array_add (metrics->values, entry);
+    g_hash_table_insert (metrics->value_index, key, entry);
+    key = NULL;
+  }
+  entry->value = value;
+  g_mutex_unlock (&metrics->lock);
+  g_free (key);
+}
+
+void
+metrics_add_collector (NvDsMetrics * metrics, NvDsMetricsCollectFunc func,
+    gpointer user_data)
+{
+  NvDsMetricsCollector collector = { func, user_data };
+
+  if (!metrics)
+    return;
+
+  g_mutex_lock (&metrics->lock);
+  g_array_append_val (metrics->collectors, collector);
+  g_mutex_unlock (&metrics->lock);
+}
+
+void
+metrics_remove_collector (NvDsMetrics * metrics,
+    NvDsMetricsCollectFunc func, gpointer user_data)
+{
+  guint i;
+
+  if (!metrics)
+    return;
+
+  g_mutex_lock (&metrics->lock);
+  for (i = 0; i < metrics->collectors->len; i++) {
+    NvDsMetricsCollector *collector =
+        &g_array_index (metrics->collectors, NvDsMetricsCollector, i);
+
+    if (collector->func == func && collector->user_data == user_data) {
+      g_array_remove_index (metrics->collectors, i);
+      break;
+    }
+  }
+  g_mutex_unlock (&metrics->lock);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_METRICS_H__
+#define __NVGSTDS_APP_METRICS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+
+/** Host the metrics server binds to when the address has none. */
+#define METRICS_DEFAULT_HOST "127.0.0.1"
+/** Prefix of a Unix socket path in the metrics address. */
+#define METRICS_UNIX_PREFIX "unix:"
+/** Bytes of an HTTP request read before it is answered or rejected. */
+#define METRICS_MAX_REQUEST 4096
+/** Time a scraper gets to send its request and read the response. */
+#define METRICS_IO_TIMEOUT_MS 1000
+
+typedef enum
+{
+  NV_DS_METRIC_GAUGE,
+  NV_DS_METRIC_COUNTER,
+  NV_DS_METRIC_SUMMARY,
+} NvDsMetricType;
+
+typedef struct _NvDsMetrics NvDsMetrics;
+typedef struct _NvDsMetricsWriter NvDsMetricsWriter;
+
+/**
+ * Appends the current value of pull metrics with metrics_writer_add(),
+ * from the server thread while the registry is locked. Must only read
+ * state the streaming threads publish without a lock.
+ */
+typedef void (*NvDsMetricsCollectFunc) (NvDsMetricsWriter * writer,
+    gpointer user_data);
+
+/**
+ * Start serving the registry in Prometheus text format over HTTP, from a
+ * thread of its own.
+ *
+ * @param[in] address "[HOST:]PORT" for TCP, METRICS_DEFAULT_HOST if no host
+ *            is given, or "unix:PATH" for a Unix stream socket.
+ *
+ * @return the registry or NULL if the socket could not be opened.
+ */
+NvDsMetrics *metrics_server_start (const gchar * address);
+
+/** Stop the server thread and release the registry. */
+void metrics_server_stop (NvDsMetrics * metrics);
+
+/**
+ * Set a push metric, creating it on first use. Takes the registry lock,
+ * so only call it from the main loop or other non streaming threads.
+ *
+ * @param[in] labels comma separated label pairs, e.g. instance="0", or
+ *            NULL.
+ */
+void metrics_set (NvDsMetrics * metrics, const gchar * name,
+    const gchar * help, NvDsMetricType type, const gchar * labels,
+    gdouble value);
+
+void metrics_add_collector (NvDsMetrics * metrics,
+    NvDsMetricsCollectFunc func, gpointer user_data);
+
+/** Once this returns @p func is not running and will not be called again. */
+void metrics_remove_collector (NvDsMetrics * metrics,
+    NvDsMetricsCollectFunc func, gpointer user_data);
+
+/**
+ * Append one sample to a metric family. Samples of the same family are
+ * grouped under one HELP/TYPE header whichever collector adds them.
+ *
+ * @param[in] suffix appended to @p name for this sample, e.g. "_sum" of a
+ *            summary, or NULL.
+ */
+void metrics_writer_add (NvDsMetricsWriter * writer, const gchar * name,
+    const gchar * help, NvDsMetricType type, const gchar * suffix,
+    const gchar * labels, gdouble value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
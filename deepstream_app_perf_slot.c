@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_app_perf_slot.h"
+
+void
+perf_slot_publish (NvDsPerfSlot * slot, const NvDsAppPerfStruct * str)
+{
+  guint seq = __atomic_load_n (&slot->seq, __ATOMIC_RELAXED);
+  guint num_streams = MIN (str->num_instances, MAX_SOURCE_BINS);
+
+  __atomic_store_n (&slot->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+
+  slot->data.updates++;
+  slot->data.num_streams = num_streams;
+  memcpy (slot->data.fps, str->fps, num_streams * sizeof (gdouble));
+  memcpy (slot->data.fps_avg, str->fps_avg, num_streams * sizeof (gdouble));
+
+  __atomic_store_n (&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void
+perf_slot_read (NvDsPerfSlot * slot, NvDsPerfSnapshot * out)
+{
+  guint seq;
+
+  do {
+    while ((seq = __atomic_load_n (&slot->seq, __ATOMIC_ACQUIRE)) & 1);
+
+    out->updates = slot->data.updates;
+    out->num_streams = MIN (slot->data.num_streams, MAX_SOURCE_BINS);
+    memcpy (out->fps, slot->data.fps, out->num_streams * sizeof (gdouble));
+    memcpy (out->fps_avg, slot->data.fps_avg,
+        out->num_streams * sizeof (gdouble));
+
+    __atomic_thread_fence (__ATOMIC_ACQUIRE);
+  } while (__atomic_load_n (&slot->seq, __ATOMIC_RELAXED) != seq);
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_PERF_SLOT_H__
+#define __NVGSTDS_APP_PERF_SLOT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "deepstream_perf.h"
+
+/** Performance numbers of every stream of one instance. */
+typedef struct
+{
+  /** Number of perf callbacks published so far. */
+  guint64 updates;
+  guint num_streams;
+  gdouble fps[MAX_SOURCE_BINS];
+  gdouble fps_avg[MAX_SOURCE_BINS];
+} NvDsPerfSnapshot;
+
+/**
+ * Latest performance numbers of an instance. Written by that instance's
+ * perf callback only and read by any number of threads through a sequence
+ * counter, so neither side waits for the other.
+ */
+typedef struct
+{
+  guint seq;
+  NvDsPerfSnapshot data;
+} NvDsPerfSlot;
+
+/** Publish the numbers of a perf callback. Single writer per slot. */
+void perf_slot_publish (NvDsPerfSlot * slot, const NvDsAppPerfStruct * str);
+
+/** Copy a consistent snapshot of the slot, from any thread. */
+void perf_slot_read (NvDsPerfSlot * slot, NvDsPerfSnapshot * out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_app_ring.h"
+
+gboolean
+spsc_ring_init (NvDsSpscRing * ring, guint elem_size, guint capacity)
+{
+  guint size = 1;
+
+  while (size < capacity)
+    size <<= 1;
+
+  memset (ring, 0, sizeof (*ring));
+  ring->buffer = g_try_malloc0 ((gsize) size * elem_size);
+  if (!ring->buffer)
+    return FALSE;
+  ring->elem_size = elem_size;
+  ring->mask = size - 1;
+  return TRUE;
+}
+
+void
+spsc_ring_deinit (NvDsSpscRing * ring)
+{
+  g_free (ring->buffer);
+  ring->buffer = NULL;
+}
+
+gboolean
+spsc_ring_push (NvDsSpscRing * ring, gconstpointer elem)
+{
+  guint head = ring->head;
+
+  if (head - ring->cached_tail > ring->mask) {
+    ring->cached_tail = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
+    if (head - ring->cached_tail > ring->mask)
+      return FALSE;
+  }
+
+  memcpy (ring->buffer + (gsize) (head & ring->mask) * ring->elem_size, elem,
+      ring->elem_size);
+  __atomic_store_n (&ring->head, head + 1, __ATOMIC_RELEASE);
+  return TRUE;
+}
+
+gboolean
+spsc_ring_pop (NvDsSpscRing * ring, gpointer elem)
+{
+  guint tail = ring->tail;
+
+  if (tail == ring->cached_head) {
+    ring->cached_head = __atomic_load_n (&ring->head, __ATOMIC_ACQUIRE);
+    if (tail == ring->cached_head)
+      return FALSE;
+  }
+
+  memcpy (elem, ring->buffer + (gsize) (tail & ring->mask) * ring->elem_size,
+      ring->elem_size);
+  __atomic_store_n (&ring->tail, tail + 1, __ATOMIC_RELEASE);
+  return TRUE;
+}
+
+guint
+spsc_ring_count (NvDsSpscRing * ring)
+{
+  /* Tail first: head only grows, so the difference cannot wrap when a third
+   * thread samples the ring. */
+  guint tail = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
+
+  return __atomic_load_n (&ring->head, __ATOMIC_ACQUIRE) - tail;
+}
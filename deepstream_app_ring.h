@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_RING_H__
+#define __NVGSTDS_APP_RING_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+
+#define SPSC_RING_CACHE_LINE 64
+
+/**
+ * Bounded single producer, single consumer ring of fixed size elements.
+ * Neither side takes a lock; the producer gets FALSE back when the ring is
+ * full and decides itself whether to drop.
+ */
+typedef struct
+{
+  guint8 *buffer;
+  guint elem_size;
+  guint mask;
+
+  /** Producer side. */
+  guint head __attribute__ ((aligned (SPSC_RING_CACHE_LINE)));
+  guint cached_tail;
+
+  /** Consumer side. */
+  guint tail __attribute__ ((aligned (SPSC_RING_CACHE_LINE)));
+  guint cached_head;
+} NvDsSpscRing;
+
+/**
+ * Allocate the ring storage.
+ *
+ * @param[in] ring ring to initialize.
+ * @param[in] elem_size size in bytes of one element.
+ * @param[in] capacity number of elements, rounded up to a power of two.
+ */
+gboolean spsc_ring_init (NvDsSpscRing * ring, guint elem_size, guint capacity);
+
+void spsc_ring_deinit (NvDsSpscRing * ring);
+
+/** Copy one element in. Producer thread only. */
+gboolean spsc_ring_push (NvDsSpscRing * ring, gconstpointer elem);
+
+/** Copy the oldest element out. Consumer thread only. */
+gboolean spsc_ring_pop (NvDsSpscRing * ring, gpointer elem);
+
+/** Number of queued elements; exact only from the consumer thread, a
+ * snapshot from any other. */
+guint spsc_ring_count (NvDsSpscRing * ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_common.h"
+#include "deepstream_config.h"
+#include "deepstream_app_roi.h"
+
+void
+roi_config_init (NvDsRoiConfig * config)
+{
+  if (!config->component_id)
+    config->component_id = ROI_DEFAULT_COMPONENT_ID;
+  if (config->scale <= 0)
+    config->scale = ROI_DEFAULT_SCALE;
+  if (!config->min_size)
+    config->min_size = ROI_DEFAULT_MIN_SIZE;
+}
+
+GstElement *
+roi_gie_new (const NvDsRoiConfig * config, const NvDsGieConfig * pgie_config)
+{
+  GstElement *gie = gst_element_factory_make (NVDS_ELEM_SGIE, "roi_gie");
+
+  if (!gie) {
+    NVGSTDS_ERR_MSG_V ("Failed to create element 'roi_gie'");
+    return NULL;
+  }
+
+  /* Set as properties, which take precedence over the config file. */
+  g_object_set (G_OBJECT (gie), "config-file-path", config->config_file_path,
+      "process-mode", 2, "infer-on-gie-id", config->component_id,
+      "unique-id", pgie_config->unique_id, "gpu-id", pgie_config->gpu_id,
+      NULL);
+  return gie;
+}
+
+gboolean
+roi_window_compute (const NvDsRoiConfig * config, const NvDsTargetSet * set,
+    guint64 pts, gfloat frame_width, gfloat frame_height,
+    NvDsRoiWindow * window)
+{
+  tracked_data target;
+  gfloat aspect, size, to_pixels;
+
+  if (frame_width <= 0 || frame_height <= 0 || set->num_targets == 0)
+    return FALSE;
+
+  target = set->targets[0];
+  if (!target.detect_flag || target.width <= 0 || target.height <= 0)
+    return FALSE;
+
+  /* The set was published for a frame further downstream; move the target
+   * to where it should be in this one. */
+  if (pts < set->pts || pts - set->pts > ROI_MAX_TARGET_AGE)
+    return FALSE;
+  target_extrapolate (&target, (gint64) ((pts - set->pts) / GST_USECOND));
+  to_pixels = frame_height / TARGET_REFERENCE_HEIGHT;
+  target.centerx *= to_pixels;
+  target.centery *= to_pixels;
+  target.width *= to_pixels;
+  target.height *= to_pixels;
+
+  aspect = frame_width / frame_height;
+  size = MAX (target.height, target.width / aspect) * config->scale;
+  size = MAX (size, (gfloat) config->min_size);
+  if (target.coasting)
+    size *= ROI_COAST_GROWTH;
+  if (size * size > frame_height * frame_height * ROI_MAX_AREA_FRACTION)
+    return FALSE;
+
+  /* Shifted rather than cut at the frame border, so the detector input
+   * keeps its scale. */
+  window->height = size;
+  window->width = size * aspect;
+  window->left = CLAMP (frame_width * 0.5f + target.centerx -
+      window->width * 0.5f, 0.0f, frame_width - window->width);
+  window->top = CLAMP (frame_height * 0.5f - target.centery -
+      window->height * 0.5f, 0.0f, frame_height - window->height);
+  return TRUE;
+}
+
+void
+roi_window_attach (const NvDsRoiConfig * config, NvDsBatchMeta * batch_meta,
+    NvDsFrameMeta * frame_meta, const NvDsRoiWindow * window)
+{
+  NvDsObjectMeta *obj = nvds_acquire_obj_meta_from_pool (batch_meta);
+
+  obj->unique_component_id = config->component_id;
+  obj->class_id = 0;
+  obj->object_id = UNTRACKED_OBJECT_ID;
+  obj->confidence = 1.0;
+  obj->obj_label[0] = '\0';
+  memset (&obj->rect_params, 0, sizeof (obj->rect_params));
+  obj->rect_params.left = window->left;
+  obj->rect_params.top = window->top;
+  obj->rect_params.width = window->width;
+  obj->rect_params.height = window->height;
+  nvds_add_obj_meta_to_frame (frame_meta, obj, NULL);
+}
+
+void
+roi_window_remove (const NvDsRoiConfig * config, NvDsFrameMeta * frame_meta)
+{
+  NvDsMetaList *l_obj, *next;
+
+  /* Detections inside a window point to it as their parent; detach them
+   * first, they may come before or after it in the list. */
+  for (l_obj = frame_meta->obj_meta_list; l_obj != NULL; l_obj = l_obj->next) {
+    NvDsObjectMeta *obj = (NvDsObjectMeta *) l_obj->data;
+    if (obj->parent &&
+        obj->parent->unique_component_id == config->component_id)
+      obj->parent = NULL;
+  }
+
+  for (l_obj = frame_meta->obj_meta_list; l_obj != NULL; l_obj = next) {
+    NvDsObjectMeta *obj = (NvDsObjectMeta *) l_obj->data;
+    next = l_obj->next;
+    if (obj->unique_component_id == config->component_id)
+      nvds_remove_obj_meta_from_frame (frame_meta, obj);
+  }
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_ROI_H__
+#define __NVGSTDS_APP_ROI_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "gstnvdsmeta.h"
+#include "deepstream_gie.h"
+#include "deepstream_app_target.h"
+
+/** unique_component_id of the window objects when roi-component-id is not
+ * set. The ROI GIE infers on objects of this component. */
+#define ROI_DEFAULT_COMPONENT_ID 99
+/** Window height as a multiple of the target size. */
+#define ROI_DEFAULT_SCALE 3.0
+/** Smallest window height in streammux pixels. */
+#define ROI_DEFAULT_MIN_SIZE 256
+/** Window growth while the target is predicted through a dropout. */
+#define ROI_COAST_GROWTH 1.5f
+/** Windows covering more of the frame than this are not worth a crop; the
+ * frame is left to the tracker until the next full frame inference. */
+#define ROI_MAX_AREA_FRACTION 0.5f
+/** Targets published longer than this before the frame are not followed. */
+#define ROI_MAX_TARGET_AGE (GST_SECOND / 2)
+
+typedef struct
+{
+  /** Config file of the ROI GIE, NULL if ROI mode is disabled. */
+  gchar *config_file_path;
+  gint component_id;
+  gdouble scale;
+  guint min_size;
+} NvDsRoiConfig;
+
+/** Crop window in streammux pixels. */
+typedef struct
+{
+  gfloat left;
+  gfloat top;
+  gfloat width;
+  gfloat height;
+} NvDsRoiWindow;
+
+/** Fill the defaults of the settings the config file left out. */
+void roi_config_init (NvDsRoiConfig * config);
+
+/**
+ * Create the ROI GIE: the detector of @p config_file_path in secondary mode,
+ * inferring only on the window objects. Its detections carry the primary
+ * GIE's unique id so that the tracker, secondary GIEs and target selection
+ * treat them like full frame detections.
+ *
+ * @return the element, NULL on failure.
+ */
+GstElement *roi_gie_new (const NvDsRoiConfig * config,
+    const NvDsGieConfig * pgie_config);
+
+/**
+ * Window around the followed target of @p set, predicted to @p pts, with
+ * the aspect ratio of the frame so the detector sees objects undistorted.
+ *
+ * @return FALSE if no target is followed, it is stale, or the window would
+ *         cover too much of the frame.
+ */
+gboolean roi_window_compute (const NvDsRoiConfig * config,
+    const NvDsTargetSet * set, guint64 pts, gfloat frame_width,
+    gfloat frame_height, NvDsRoiWindow * window);
+
+/**
+ * Attach @p window to a frame as an object the ROI GIE infers on.
+ */
+void roi_window_attach (const NvDsRoiConfig * config,
+    NvDsBatchMeta * batch_meta, NvDsFrameMeta * frame_meta,
+    const NvDsRoiWindow * window);
+
+/**
+ * Remove the window objects of a frame once the ROI GIE has run. Their
+ * detections become frame level objects.
+ */
+void roi_window_remove (const NvDsRoiConfig * config,
+    NvDsFrameMeta * frame_meta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_SEQLOCK_H__
+#define __NVGSTDS_APP_SEQLOCK_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <glib.h>
+
+/**
+ * Sequence lock for one writer and any number of readers. The writer never
+ * waits; a reader copies the protected data and retries while the count was
+ * odd (write in progress) or changed during the copy. Only depends on GLib
+ * so tools can benchmark it.
+ */
+
+static inline void
+seqlock_write_begin (gint * seq)
+{
+  __atomic_store_n (seq, __atomic_load_n (seq, __ATOMIC_RELAXED) + 1,
+      __ATOMIC_RELAXED);
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+}
+
+static inline void
+seqlock_write_end (gint * seq)
+{
+  __atomic_store_n (seq, __atomic_load_n (seq, __ATOMIC_RELAXED) + 1,
+      __ATOMIC_RELEASE);
+}
+
+static inline gint
+seqlock_read_begin (const gint * seq)
+{
+  return __atomic_load_n (seq, __ATOMIC_ACQUIRE);
+}
+
+/** TRUE if the data copied since seqlock_read_begin() may be torn. */
+static inline gboolean
+seqlock_read_retry (const gint * seq, gint start)
+{
+  __atomic_thread_fence (__ATOMIC_ACQUIRE);
+  return (start & 1) || __atomic_load_n (seq, __ATOMIC_RELAXED) != start;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
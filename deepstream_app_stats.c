@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_app_stats.h"
+
+typedef struct
+{
+  /** Window being counted, only touched by the streaming thread. */
+  NvDsStatsCounts current;
+  GMutex lock;
+  NvDsStreamStats published;
+} NvDsStreamStatsState;
+
+struct _NvDsAppStats
+{
+  NvDsStreamStatsState *streams;
+  guint num_streams;
+};
+
+NvDsAppStats *
+app_stats_new (guint num_streams)
+{
+  NvDsAppStats *stats = g_new0 (NvDsAppStats, 1);
+  guint i;
+
+  stats->streams = g_new0 (NvDsStreamStatsState, num_streams);
+  stats->num_streams = num_streams;
+  for (i = 0; i < num_streams; i++)
+    g_mutex_init (&stats->streams[i].lock);
+  return stats;
+}
+
+void
+app_stats_free (NvDsAppStats * stats)
+{
+  guint i;
+
+  if (!stats)
+    return;
+
+  for (i = 0; i < stats->num_streams; i++)
+    g_mutex_clear (&stats->streams[i].lock);
+  g_free (stats->streams);
+  g_free (stats);
+}
+
+NvDsStatsCounts *
+app_stats_begin_frame (NvDsAppStats * stats, guint stream_id)
+{
+  if (!stats || stream_id >= stats->num_streams)
+    return NULL;
+  return &stats->streams[stream_id].current;
+}
+
+static void
+stats_counts_add (NvDsStatsCounts * total, NvDsStatsCounts * counts)
+{
+  guint i, j;
+
+  total->frames += counts->frames;
+  for (i = 0; i < STATS_MAX_CLASSES; i++)
+    total->objects[i] += counts->objects[i];
+  for (i = 0; i < STATS_MAX_CLASSIFIERS; i++) {
+    for (j = 0; j < STATS_MAX_RESULT_CLASSES; j++)
+      total->attributes[i][j] += counts->attributes[i][j];
+  }
+}
+
+void
+app_stats_end_frame (NvDsAppStats * stats, guint stream_id)
+{
+  NvDsStreamStatsState *stream;
+
+  if (!stats || stream_id >= stats->num_streams)
+    return;
+
+  stream = &stats->streams[stream_id];
+  if (++stream->current.frames < STATS_WINDOW_FRAMES)
+    return;
+
+  g_mutex_lock (&stream->lock);
+  stream->published.window = stream->current;
+  stats_counts_add (&stream->published.total, &stream->current);
+  g_mutex_unlock (&stream->lock);
+  memset (&stream->current, 0, sizeof (stream->current));
+}
+
+gboolean
+app_stats_get (NvDsAppStats * stats, guint stream_id, NvDsStreamStats * out)
+{
+  NvDsStreamStatsState *stream;
+
+  if (!stats || stream_id >= stats->num_streams)
+    return FALSE;
+
+  stream = &stats->streams[stream_id];
+  g_mutex_lock (&stream->lock);
+  *out = stream->published;
+  g_mutex_unlock (&stream->lock);
+  return TRUE;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __NVGSTDS_APP_STATS_H__
+#define __NVGSTDS_APP_STATS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "deepstream_config.h"
+
+/** Primary GIE classes counted per stream. */
+#define STATS_MAX_CLASSES 128
+/** Classifier GIEs counted, by rank of their unique id. */
+#define STATS_MAX_CLASSIFIERS (MAX_SECONDARY_GIE_BINS + 1)
+/** Result classes counted per classifier, e.g. the labels of a gender
+ * classifier. */
+#define STATS_MAX_RESULT_CLASSES 16
+/** Frames per published window. */
+#define STATS_WINDOW_FRAMES 30
+
+typedef struct
+{
+  guint64 frames;
+  guint64 objects[STATS_MAX_CLASSES];
+  guint64 attributes[STATS_MAX_CLASSIFIERS][STATS_MAX_RESULT_CLASSES];
+} NvDsStatsCounts;
+
+/** Counters of one stream, as of the last completed window. */
+typedef struct
+{
+  /** Counts over the last STATS_WINDOW_FRAMES frames. */
+  NvDsStatsCounts window;
+  /** Counts since the pipeline started. */
+  NvDsStatsCounts total;
+} NvDsStreamStats;
+
+typedef struct _NvDsAppStats NvDsAppStats;
+
+NvDsAppStats *app_stats_new (guint num_streams);
+void app_stats_free (NvDsAppStats * stats);
+
+/**
+ * Counters to add the objects of a frame to, from the streaming thread of
+ * the stream. Close the frame with app_stats_end_frame().
+ *
+ * @return NULL if @p stream_id is out of range.
+ */
+NvDsStatsCounts *app_stats_begin_frame (NvDsAppStats * stats,
+    guint stream_id);
+
+void app_stats_end_frame (NvDsAppStats * stats, guint stream_id);
+
+/** Copy the counters of a stream, from any thread. */
+gboolean app_stats_get (NvDsAppStats * stats, guint stream_id,
+    NvDsStreamStats * out);
+
+static inline void
+app_stats_count_object (NvDsStatsCounts * counts, gint class_id)
+{
+  if ((guint) class_id < STATS_MAX_CLASSES)
+    counts->objects[class_id]++;
+}
+
+static inline void
+app_stats_count_attribute (NvDsStatsCounts * counts, guint classifier_rank,
+    gint result_class_id)
+{
+  if (classifier_rank < STATS_MAX_CLASSIFIERS
+      && (guint) result_class_id < STATS_MAX_RESULT_CLASSES)
+    counts->attributes[classifier_rank][result_class_id]++;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string.h>
+
+#include "deepstream_app_seqlock.h"
+#include "deepstream_app_target.h"
+
+#define TARGET_INDEX_EMPTY UNTRACKED_OBJECT_ID
+
+/* Predictor noise in units of the frame height: white acceleration
+ * spectral density and variance of the detected center. */
+#define TARGET_PROCESS_NOISE 1.0f
+#define TARGET_MEASUREMENT_NOISE 2.5e-5f
+/* Frame gaps above this restart the predictor. */
+#define TARGET_MAX_PREDICT_GAP GST_SECOND
+/* Targets are never extrapolated further than this at send time. */
+#define TARGET_MAX_EXTRAPOLATE_US 250000
+
+static inline guint
+target_index_hash (guint64 object_id)
+{
+  /* Tracker ids are sequential, spread them with Fibonacci hashing. */
+  return (guint) ((object_id * 0x9E3779B97F4A7C15ULL) >>
+      (64 - TARGET_CANDIDATE_BITS - 1));
+}
+
+static void
+target_table_clear (NvDsTargetTable * table)
+{
+  memset (table->index_keys, 0xFF, sizeof (table->index_keys));
+  table->num_candidates = 0;
+}
+
+static NvDsTargetCandidate *
+target_table_lookup (NvDsTargetTable * table, guint64 object_id)
+{
+  guint pos;
+
+  if (object_id == UNTRACKED_OBJECT_ID)
+    return NULL;
+
+  for (pos = target_index_hash (object_id);
+      table->index_keys[pos] != TARGET_INDEX_EMPTY;
+      pos = (pos + 1) & (TARGET_INDEX_SIZE - 1)) {
+    if (table->index_keys[pos] == object_id)
+      return &table->slots[table->index_slots[pos]];
+  }
+  return NULL;
+}
+
+/**
+ * Append a candidate to the table. Untracked objects take a slot but are
+ * not indexed since they cannot be recognized in the next frame.
+ * Returns the slot number or -1 if the table is full.
+ */
+static gint
+target_table_append (NvDsTargetTable * table, guint64 object_id)
+{
+  guint slot = table->num_candidates;
+  guint pos;
+
+  if (slot == TARGET_MAX_CANDIDATES)
+    return -1;
+
+  if (object_id != UNTRACKED_OBJECT_ID) {
+    for (pos = target_index_hash (object_id);
+        table->index_keys[pos] != TARGET_INDEX_EMPTY;
+        pos = (pos + 1) & (TARGET_INDEX_SIZE - 1)) {
+      /* Duplicate id within a frame, keep the first one. */
+      if (table->index_keys[pos] == object_id)
+        return -1;
+    }
+    table->index_keys[pos] = object_id;
+    table->index_slots[pos] = slot;
+  }
+  table->ids[slot] = object_id;
+  table->num_candidates++;
+  return slot;
+}
+
+static void
+target_snapshot_store (NvDsTargetSnapshot * snapshot, const NvDsTargetSet * set)
+{
+  seqlock_write_begin (&snapshot->seq);
+  memcpy (&snapshot->set, set, sizeof (*set));
+  seqlock_write_end (&snapshot->seq);
+}
+
+static void
+target_snapshot_load (NvDsTargetSnapshot * snapshot, NvDsTargetSet * set)
+{
+  gint seq;
+
+  do {
+    seq = seqlock_read_begin (&snapshot->seq);
+    memcpy (set, &snapshot->set, sizeof (*set));
+  } while (seqlock_read_retry (&snapshot->seq, seq));
+}
+
+static void
+target_predictor_start (NvDsTargetPredictor * pred, gfloat x, gfloat y,
+    guint64 pts)
+{
+  guint i;
+
+  pred->valid = TRUE;
+  pred->pos[0] = x;
+  pred->pos[1] = y;
+  for (i = 0; i < 2; i++) {
+    pred->vel[i] = 0;
+    pred->p_pp[i] = TARGET_MEASUREMENT_NOISE;
+    pred->p_pv[i] = 0;
+    /* Unknown velocity, up to about one frame height per second. */
+    pred->p_vv[i] = 1.0f;
+  }
+  pred->pts = pts;
+  pred->update_pts = pts;
+}
+
+/** Move the state forward to @p pts. Returns FALSE if it is too far off. */
+static gboolean
+target_predictor_predict (NvDsTargetPredictor * pred, guint64 pts)
+{
+  gfloat dt, q = TARGET_PROCESS_NOISE;
+  guint i;
+
+  if (pts <= pred->pts)
+    return pts == pred->pts;
+  if (pts - pred->pts > TARGET_MAX_PREDICT_GAP)
+    return FALSE;
+
+  dt = (gfloat) (pts - pred->pts) / GST_SECOND;
+  for (i = 0; i < 2; i++) {
+    pred->pos[i] += pred->vel[i] * dt;
+    pred->p_pp[i] += dt * (2 * pred->p_pv[i] + dt * pred->p_vv[i]) +
+        q * dt * dt * dt / 3;
+    pred->p_pv[i] += dt * pred->p_vv[i] + q * dt * dt / 2;
+    pred->p_vv[i] += q * dt;
+  }
+  pred->pts = pts;
+  return TRUE;
+}
+
+static void
+target_predictor_update (NvDsTargetPredictor * pred, gfloat x, gfloat y)
+{
+  gfloat z[2] = { x, y };
+  guint i;
+
+  for (i = 0; i < 2; i++) {
+    gfloat s = pred->p_pp[i] + TARGET_MEASUREMENT_NOISE;
+    gfloat k_p = pred->p_pp[i] / s;
+    gfloat k_v = pred->p_pv[i] / s;
+    gfloat innovation = z[i] - pred->pos[i];
+
+    pred->pos[i] += k_p * innovation;
+    pred->vel[i] += k_v * innovation;
+    pred->p_vv[i] -= k_v * pred->p_pv[i];
+    pred->p_pp[i] *= 1 - k_p;
+    pred->p_pv[i] *= 1 - k_p;
+  }
+  pred->update_pts = pred->pts;
+}
+
+static void
+target_stream_reset (NvDsTargetStream * stream)
+{
+  target_table_clear (&stream->tables[0]);
+  target_table_clear (&stream->tables[1]);
+  stream->centerx = 0;
+  stream->centery = 0;
+  stream->locked_id = UNTRACKED_OBJECT_ID;
+  stream->predictor.valid = FALSE;
+  memset (&stream->published, 0, sizeof (stream->published));
+  stream->published.targets[0].object_id = UNTRACKED_OBJECT_ID;
+  stream->published.num_targets = 1;
+  target_snapshot_store (&stream->snapshot, &stream->published);
+}
+
+void
+target_selector_init (NvDsTargetSelector * selector, guint frame_width,
+    guint frame_height, gfloat gate_radius, NvDsClassFilter * class_filter,
+    guint max_coast_ms)
+{
+  if (!frame_width || !frame_height) {
+    frame_width = TARGET_DEFAULT_FRAME_WIDTH;
+    frame_height = TARGET_DEFAULT_FRAME_HEIGHT;
+  }
+  if (gate_radius <= 0.0f)
+    gate_radius = TARGET_DEFAULT_GATE_RADIUS;
+
+  selector->frame_width = frame_width;
+  selector->frame_height = frame_height;
+  selector->gate_radius_sq = gate_radius * gate_radius;
+  selector->class_filter = class_filter;
+  selector->max_coast = (guint64) (max_coast_ms ? max_coast_ms :
+      TARGET_DEFAULT_MAX_COAST_MS) * GST_MSECOND;
+}
+
+void
+target_selector_destroy (NvDsTargetSelector * selector)
+{
+  guint i;
+
+  for (i = 0; i < MAX_SOURCE_BINS; i++) {
+    g_free (selector->streams[i]);
+    selector->streams[i] = NULL;
+  }
+}
+
+void
+target_selector_request_reset (NvDsTargetSelector * selector)
+{
+  g_atomic_int_inc (&selector->reset_generation);
+}
+
+NvDsTargetStream *
+target_selector_process_frame (NvDsTargetSelector * selector,
+    NvDsFrameMeta * frame_meta)
+{
+  guint stream_id = frame_meta->pad_index;
+  NvDsTargetStream *stream;
+  NvDsTargetTable *prev, *cur;
+  NvDsTargetPredictor *pred;
+  tracked_data *followed;
+  guint64 pts = frame_meta->buf_pts;
+  gfloat scale, center_x, center_y;
+  gint generation;
+  guint top[TARGET_MAX_PUBLISHED];
+  guint num_top = 0;
+  guint i;
+
+  if (stream_id >= MAX_SOURCE_BINS || selector->frame_height <= 0.0f ||
+      !selector->class_filter)
+    return NULL;
+
+  scale = 1.0f / selector->frame_height;
+  center_x = selector->frame_width * 0.5f;
+  center_y = selector->frame_height * 0.5f;
+
+  stream = selector->streams[stream_id];
+  if (!stream) {
+    stream = g_new0 (NvDsTargetStream, 1);
+    target_stream_reset (stream);
+    g_atomic_pointer_set (&selector->streams[stream_id], stream);
+  }
+
+  generation = g_atomic_int_get (&selector->reset_generation);
+  if (frame_meta->frame_num == 0 || stream->reset_generation != generation) {
+    target_stream_reset (stream);
+    stream->reset_generation = generation;
+  }
+
+  /* Search around where the followed target should be by now. */
+  pred = &stream->predictor;
+  if (pred->valid) {
+    if (target_predictor_predict (pred, pts)) {
+      stream->centerx = pred->pos[0];
+      stream->centery = pred->pos[1];
+    } else {
+      pred->valid = FALSE;
+    }
+  }
+
+  prev = &stream->tables[stream->cur];
+  cur = &stream->tables[stream->cur ^ 1];
+  target_table_clear (cur);
+
+  for (NvDsMetaList * l_obj = frame_meta->obj_meta_list; l_obj != NULL;
+      l_obj = l_obj->next) {
+    NvDsObjectMeta *obj = (NvDsObjectMeta *) l_obj->data;
+    NvDsTargetCandidate *cand, *seen;
+    gfloat dx, dy;
+    gint slot;
+
+    if (!class_filter_match (selector->class_filter, obj))
+      continue;
+
+    slot = target_table_append (cur, obj->object_id);
+    if (slot < 0)
+      continue;
+
+    cand = &cur->slots[slot];
+    cand->width = obj->rect_params.width * scale;
+    cand->height = obj->rect_params.height * scale;
+    cand->centerx = (obj->rect_params.left +
+        obj->rect_params.width * 0.5f - center_x) * scale;
+    cand->centery = (obj->rect_params.top +
+        obj->rect_params.height * 0.5f - center_y) * scale;
+
+    seen = target_table_lookup (prev, obj->object_id);
+    cand->hits = seen ? seen->hits + 1 : 1;
+
+    /* The followed track keeps its lock while the tracker keeps its id,
+     * everything else is ranked by distance to the last target position. */
+    if (obj->object_id != UNTRACKED_OBJECT_ID &&
+        obj->object_id == stream->locked_id) {
+      cand->score = 0;
+    } else {
+      dx = cand->centerx - stream->centerx;
+      dy = cand->centery - stream->centery;
+      cand->score = dx * dx + dy * dy;
+    }
+
+    /* Insertion into the small sorted top-K list. */
+    for (i = num_top; i > 0 && cur->slots[top[i - 1]].score > cand->score;
+        i--) {
+      if (i < TARGET_MAX_PUBLISHED)
+        top[i] = top[i - 1];
+    }
+    if (i < TARGET_MAX_PUBLISHED) {
+      top[i] = slot;
+      if (num_top < TARGET_MAX_PUBLISHED)
+        num_top++;
+    }
+  }
+  stream->cur ^= 1;
+
+  followed = &stream->published.targets[0];
+  if (num_top > 0 && cur->slots[top[0]].score <= selector->gate_radius_sq) {
+    NvDsTargetCandidate *best = &cur->slots[top[0]];
+    if (!pred->valid || cur->ids[top[0]] != stream->locked_id ||
+        cur->ids[top[0]] == UNTRACKED_OBJECT_ID)
+      target_predictor_start (pred, best->centerx, best->centery, pts);
+    else
+      target_predictor_update (pred, best->centerx, best->centery);
+    stream->locked_id = cur->ids[top[0]];
+  } else {
+    num_top = 0;
+    if (pred->valid && pts - pred->update_pts > selector->max_coast)
+      pred->valid = FALSE;
+  }
+
+  /* Published at the reference resolution the mission program expects, so
+   * the values do not change with the streammux resolution. */
+  for (i = 0; i < num_top; i++) {
+    NvDsTargetCandidate *cand = &cur->slots[top[i]];
+    tracked_data *target = &stream->published.targets[i];
+    target->centerx = cand->centerx * TARGET_REFERENCE_HEIGHT;
+    target->centery = -cand->centery * TARGET_REFERENCE_HEIGHT;
+    target->width = cand->width * TARGET_REFERENCE_HEIGHT;
+    target->height = cand->height * TARGET_REFERENCE_HEIGHT;
+    target->velx = 0;
+    target->vely = 0;
+    target->detect_flag = 1;
+    target->coasting = 0;
+    target->object_id = cur->ids[top[i]];
+  }
+
+  /* The followed target reports the filtered state; through a short
+   * dropout it keeps coasting on the prediction. */
+  if (pred->valid) {
+    stream->centerx = pred->pos[0];
+    stream->centery = pred->pos[1];
+    followed->centerx = pred->pos[0] * TARGET_REFERENCE_HEIGHT;
+    followed->centery = -pred->pos[1] * TARGET_REFERENCE_HEIGHT;
+    followed->velx = pred->vel[0] * TARGET_REFERENCE_HEIGHT;
+    followed->vely = -pred->vel[1] * TARGET_REFERENCE_HEIGHT;
+    followed->detect_flag = 1;
+    followed->coasting = num_top == 0;
+  } else {
+    /* Lost; keep searching around the last known position. */
+    followed->velx = 0;
+    followed->vely = 0;
+    followed->detect_flag = 0;
+    followed->coasting = 0;
+  }
+  stream->published.pts = pts;
+  stream->published.num_targets = MAX (num_top, 1);
+  target_snapshot_store (&stream->snapshot, &stream->published);
+
+  return stream;
+}
+
+gboolean
+target_selector_read (NvDsTargetSelector * selector, guint stream_id,
+    NvDsTargetSet * set)
+{
+  NvDsTargetStream *stream;
+
+  if (stream_id >= MAX_SOURCE_BINS)
+    return FALSE;
+
+  stream = g_atomic_pointer_get (&selector->streams[stream_id]);
+  if (!stream)
+    return FALSE;
+
+  target_snapshot_load (&stream->snapshot, set);
+  return TRUE;
+}
+
+void
+target_extrapolate (tracked_data * target, gint64 dt_us)
+{
+  gfloat dt;
+
+  if (!target->detect_flag || dt_us <= 0)
+    return;
+
+  dt = (gfloat) MIN (dt_us, TARGET_MAX_EXTRAPOLATE_US) / G_TIME_SPAN_SECOND;
+  target->centerx += target->velx * dt;
+  target->centery += target->vely * dt;
+}
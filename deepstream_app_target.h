@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_TARGET_H__
+#define __NVGSTDS_APP_TARGET_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "gstnvdsmeta.h"
+#include "deepstream_config.h"
+#include "deepstream_app_class_filter.h"
+
+/** log2 of the number of candidate tracks kept per stream and frame. */
+#define TARGET_CANDIDATE_BITS 6
+#define TARGET_MAX_CANDIDATES (1 << TARGET_CANDIDATE_BITS)
+/** Open addressing index is kept at most half full. */
+#define TARGET_INDEX_SIZE (TARGET_MAX_CANDIDATES << 1)
+/** Number of best ranked targets published per stream. */
+#define TARGET_MAX_PUBLISHED 4
+/** Candidates further than this from the last target position are not
+ *  followed, in units of the frame height (250 px at 1080 lines). */
+#define TARGET_DEFAULT_GATE_RADIUS (250.0f / 1080.0f)
+/** Resolution assumed when the streammux group sets none. */
+#define TARGET_DEFAULT_FRAME_WIDTH 1920
+#define TARGET_DEFAULT_FRAME_HEIGHT 1080
+/** How long the followed target is extrapolated after its last detection. */
+#define TARGET_DEFAULT_MAX_COAST_MS 200
+/** Published targets are in pixels of the frame scaled to this many lines,
+ *  whatever the streammux resolution. */
+#define TARGET_REFERENCE_HEIGHT 1080.0f
+
+/**
+ * Target as reported to the mission program, in pixels of the frame scaled
+ * to TARGET_REFERENCE_HEIGHT lines (streammux pixels of a 1920x1080 mux).
+ * Center is relative to the frame center with y pointing up.
+ */
+typedef struct
+{
+  gfloat centerx;
+  gfloat centery;
+  gfloat width;
+  gfloat height;
+  /** Velocity of the center in pixels per second, y pointing up. */
+  gfloat velx;
+  gfloat vely;
+  gchar detect_flag;
+  /** Position predicted through a dropout, not measured in this frame. */
+  gchar coasting;
+  guint64 object_id;
+} tracked_data;
+
+/**
+ * Candidate geometry is kept in units of the frame height relative to the
+ * frame center, so scoring does not depend on the streammux resolution.
+ */
+typedef struct
+{
+  gfloat centerx;
+  gfloat centery;
+  gfloat width;
+  gfloat height;
+  gfloat score;
+  /** Number of consecutive frames the track has been a candidate. */
+  guint hits;
+} NvDsTargetCandidate;
+
+/**
+ * Candidates of one frame. Keys live in their own array so that probing
+ * the index does not drag the candidate payload through the cache.
+ */
+typedef struct
+{
+  guint64 index_keys[TARGET_INDEX_SIZE];
+  guint8 index_slots[TARGET_INDEX_SIZE];
+  guint64 ids[TARGET_MAX_CANDIDATES];
+  NvDsTargetCandidate slots[TARGET_MAX_CANDIDATES];
+  guint num_candidates;
+} NvDsTargetTable;
+
+/**
+ * Constant velocity Kalman filter of the followed target, one independent
+ * position/velocity pair per axis, in units of the frame height.
+ */
+typedef struct
+{
+  gboolean valid;
+  gfloat pos[2];
+  gfloat vel[2];
+  /** Per axis covariance: var(pos), cov(pos, vel), var(vel). */
+  gfloat p_pp[2];
+  gfloat p_pv[2];
+  gfloat p_vv[2];
+  /** PTS the state refers to and of the last measurement. */
+  guint64 pts;
+  guint64 update_pts;
+} NvDsTargetPredictor;
+
+/** Targets published for one stream at the end of a frame. */
+typedef struct
+{
+  /** PTS of the frame the set was published for. */
+  guint64 pts;
+  guint num_targets;
+  /** targets[0] is the followed target, the rest are runner-ups. */
+  tracked_data targets[TARGET_MAX_PUBLISHED];
+} NvDsTargetSet;
+
+/**
+ * Sequence lock around the published set. The streaming thread is the only
+ * writer and never waits; readers retry while a write is in progress.
+ */
+typedef struct
+{
+  gint seq;
+  NvDsTargetSet set;
+} NvDsTargetSnapshot;
+
+typedef struct
+{
+  /** Current and previous frame candidates, swapped every frame. */
+  NvDsTargetTable tables[2];
+  guint cur;
+  gint reset_generation;
+  /** Last followed position relative to the frame center, y down, in units
+   *  of the frame height. */
+  gfloat centerx;
+  gfloat centery;
+  guint64 locked_id;
+  NvDsTargetPredictor predictor;
+  /** Writer side copy of the last published set. */
+  NvDsTargetSet published;
+  NvDsTargetSnapshot snapshot;
+} NvDsTargetStream;
+
+typedef struct
+{
+  /** Allocated on the first frame seen from the stream. */
+  NvDsTargetStream *streams[MAX_SOURCE_BINS];
+  gint reset_generation;
+  /** Streammux output resolution the object coordinates refer to. */
+  gfloat frame_width;
+  gfloat frame_height;
+  /** Squared gate radius in units of the frame height. */
+  gfloat gate_radius_sq;
+  /** Classes that can be followed. */
+  NvDsClassFilter *class_filter;
+  /** Dropouts longer than this are reported as a loss. */
+  guint64 max_coast;
+} NvDsTargetSelector;
+
+/**
+ * Set up the selector for the streammux output resolution.
+ *
+ * @param[in] selector selector embedded in the application context.
+ * @param[in] frame_width streammux output width, 0 for the default.
+ * @param[in] frame_height streammux output height, 0 for the default.
+ * @param[in] gate_radius gate in units of the frame height, 0 for
+ *            TARGET_DEFAULT_GATE_RADIUS.
+ * @param[in] class_filter classes that can be followed, owned by the caller.
+ * @param[in] max_coast_ms how long the followed target is predicted through
+ *            a dropout, 0 for TARGET_DEFAULT_MAX_COAST_MS.
+ */
+void target_selector_init (NvDsTargetSelector * selector, guint frame_width,
+    guint frame_height, gfloat gate_radius, NvDsClassFilter * class_filter,
+    guint max_coast_ms);
+
+/**
+ * Release the per-stream state held by the selector.
+ *
+ * @param[in] selector selector embedded in the application context.
+ */
+void target_selector_destroy (NvDsTargetSelector * selector);
+
+/**
+ * Ask every stream of the selector to drop its target on the next frame.
+ * Safe to call from any thread.
+ */
+void target_selector_request_reset (NvDsTargetSelector * selector);
+
+/**
+ * Score all candidates of a frame in one pass and publish the best ranked
+ * targets of its stream. Called from the streaming thread.
+ *
+ * @return the stream state holding the published targets, NULL if the
+ *         frame could not be processed.
+ */
+NvDsTargetStream *target_selector_process_frame (NvDsTargetSelector * selector,
+    NvDsFrameMeta * frame_meta);
+
+/**
+ * Copy the last targets published for a stream without blocking the
+ * streaming thread. Safe to call from any thread.
+ *
+ * @param[in]  selector selector embedded in the application context.
+ * @param[in]  stream_id pad index of the stream.
+ * @param[out] set filled with the published targets.
+ *
+ * @return FALSE if nothing was published for the stream yet.
+ */
+gboolean target_selector_read (NvDsTargetSelector * selector, guint stream_id,
+    NvDsTargetSet * set);
+
+/**
+ * Extrapolate a published target along its velocity.
+ *
+ * @param[in,out] target target to move.
+ * @param[in] dt_us time since the frame the target was measured on.
+ */
+void target_extrapolate (tracked_data * target, gint64 dt_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,488 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "deepstream_common.h"
+#include "deepstream_app_ring.h"
+#include "deepstream_app_telemetry.h"
+
+/* Packet layout expected by the legacy mission program: four native floats
+ * (center x, center y, width, height) followed by the detect flag. */
+#define TELEMETRY_LEGACY_PACKET_SIZE 17
+
+typedef struct
+{
+  NvDsTelemetrySample last;
+  guint loss_count;
+} NvDsTelemetryStream;
+
+struct _NvDsTelemetryCtx
+{
+  NvDsTelemetryConfig config;
+  gint sock;
+  struct sockaddr_storage addr;
+  socklen_t addr_len;
+  NvDsSpscRing ring;
+  GThread *thread;
+  GMutex lock;
+  GCond cond;
+  gint waiting;
+  gint stop;
+  gint dropped;
+  /* Sender thread only. */
+  NvDsTelemetryStream *streams[MAX_SOURCE_BINS];
+  guint active[MAX_SOURCE_BINS];
+  guint num_active;
+  guint32 seq;
+  struct mmsghdr msgs[TELEMETRY_BATCH_SIZE];
+  struct iovec iovs[TELEMETRY_BATCH_SIZE];
+  guint8 packets[TELEMETRY_BATCH_SIZE][TELEMETRY_MAX_PACKET_SIZE];
+  guint num_msgs;
+  guint send_errors;
+};
+
+static inline guint8 *
+put_u16 (guint8 * p, guint16 v)
+{
+  v = GUINT16_TO_LE (v);
+  memcpy (p, &v, sizeof (v));
+  return p + sizeof (v);
+}
+
+static inline guint8 *
+put_u32 (guint8 * p, guint32 v)
+{
+  v = GUINT32_TO_LE (v);
+  memcpy (p, &v, sizeof (v));
+  return p + sizeof (v);
+}
+
+static inline guint8 *
+put_u64 (guint8 * p, guint64 v)
+{
+  v = GUINT64_TO_LE (v);
+  memcpy (p, &v, sizeof (v));
+  return p + sizeof (v);
+}
+
+static inline guint8 *
+put_f32 (guint8 * p, gfloat f)
+{
+  guint32 v;
+
+  memcpy (&v, &f, sizeof (v));
+  return put_u32 (p, v);
+}
+
+static NvDsTelemetryStream *
+telemetry_stream_get (NvDsTelemetryCtx * ctx, guint stream_id)
+{
+  NvDsTelemetryStream *stream;
+
+  if (stream_id >= MAX_SOURCE_BINS)
+    return NULL;
+
+  stream = ctx->streams[stream_id];
+  if (!stream) {
+    stream = g_new0 (NvDsTelemetryStream, 1);
+    stream->last.stream_id = stream_id;
+    ctx->streams[stream_id] = stream;
+    ctx->active[ctx->num_active++] = stream_id;
+  }
+  return stream;
+}
+
+static gsize
+telemetry_encode_legacy (guint8 * packet, const tracked_data * target,
+    gchar detect_flag)
+{
+  gfloat fields[4] = { target->centerx, target->centery, target->width,
+    target->height
+  };
+
+  memcpy (packet, fields, sizeof (fields));
+  packet[sizeof (fields)] = detect_flag;
+  return TELEMETRY_LEGACY_PACKET_SIZE;
+}
+
+static gsize
+telemetry_encode_framed (NvDsTelemetryCtx * ctx, guint8 * packet,
+    const NvDsTelemetrySample * sample, gchar detect_flag, guint8 flags)
+{
+  guint num_targets = MIN (sample->set.num_targets, TARGET_MAX_PUBLISHED);
+  guint8 *p = packet;
+  guint i;
+
+  p = put_u16 (p, TELEMETRY_MAGIC);
+  *p++ = TELEMETRY_WIRE_VERSION;
+  *p++ = flags;
+  p = put_u32 (p, ctx->seq++);
+  p = put_u64 (p, sample->pts);
+  p = put_u16 (p, sample->stream_id);
+  *p++ = num_targets;
+  *p++ = 0;
+
+  for (i = 0; i < num_targets; i++) {
+    const tracked_data *target = &sample->set.targets[i];
+    p = put_u64 (p, target->object_id);
+    p = put_f32 (p, target->centerx);
+    p = put_f32 (p, target->centery);
+    p = put_f32 (p, target->width);
+    p = put_f32 (p, target->height);
+    *p++ = i == 0 ? detect_flag : target->detect_flag;
+    memset (p, 0, 3);
+    p += 3;
+  }
+  return p - packet;
+}
+
+/**
+ * Hand all queued datagrams to the kernel. sendmmsg() may stop early, the
+ * remainder is retried until the kernel refuses the first one.
+ */
+static void
+telemetry_flush (NvDsTelemetryCtx * ctx)
+{
+  guint sent = 0;
+
+  while (sent < ctx->num_msgs) {
+    gint ret = sendmmsg (ctx->sock, &ctx->msgs[sent], ctx->num_msgs - sent, 0);
+    if (ret <= 0) {
+      ctx->send_errors += ctx->num_msgs - sent;
+      break;
+    }
+    sent += ret;
+  }
+  ctx->num_msgs = 0;
+}
+
+static void
+telemetry_queue_sample (NvDsTelemetryCtx * ctx, NvDsTelemetryStream * stream)
+{
+  NvDsTelemetrySample sample = stream->last;
+  tracked_data *target = &sample.set.targets[0];
+  guint8 *packet = ctx->packets[ctx->num_msgs];
+  guint8 flags = 0;
+  gchar detect_flag;
+
+  /* A single missed frame is not reported as a loss. Flag : detect = 1,
+   * loss = 0 */
+  if (target->detect_flag == 0) {
+    stream->loss_count++;
+    detect_flag = stream->loss_count > 1 ? 0 : 1;
+  } else {
+    stream->loss_count = 0;
+    detect_flag = 1;
+  }
+
+  if (detect_flag)
+    flags |= TELEMETRY_FLAG_DETECTED;
+  if (target->coasting)
+    flags |= TELEMETRY_FLAG_COASTING;
+
+  /* Report where the target is now rather than where it was when the
+   * frame was captured. */
+  if (ctx->config.latency_compensation && sample.capture_time) {
+    target_extrapolate (target, g_get_monotonic_time () - sample.capture_time);
+    flags |= TELEMETRY_FLAG_EXTRAPOLATED;
+  }
+
+  if (ctx->config.format == NV_DS_TELEMETRY_FORMAT_LEGACY)
+    ctx->iovs[ctx->num_msgs].iov_len =
+        telemetry_encode_legacy (packet, target, detect_flag);
+  else
+    ctx->iovs[ctx->num_msgs].iov_len =
+        telemetry_encode_framed (ctx, packet, &sample, detect_flag, flags);
+
+  if (++ctx->num_msgs == TELEMETRY_BATCH_SIZE)
+    telemetry_flush (ctx);
+}
+
+static gboolean
+telemetry_open_socket (NvDsTelemetryCtx * ctx)
+{
+  NvDsTelemetryConfig *config = &ctx->config;
+  struct sockaddr_in *in_addr = (struct sockaddr_in *) &ctx->addr;
+  struct sockaddr_un *un_addr = (struct sockaddr_un *) &ctx->addr;
+
+  switch (config->type) {
+    case NV_DS_TELEMETRY_UDP:
+    case NV_DS_TELEMETRY_UDP_MULTICAST:
+      in_addr->sin_family = AF_INET;
+      in_addr->sin_port = htons (config->port);
+      if (!config->host || !inet_aton (config->host, &in_addr->sin_addr)) {
+        NVGSTDS_ERR_MSG_V ("Invalid telemetry host '%s'", config->host);
+        return FALSE;
+      }
+      ctx->addr_len = sizeof (*in_addr);
+      ctx->sock = socket (PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+      break;
+    case NV_DS_TELEMETRY_UNIX:
+      if (!config->path || strlen (config->path) >= sizeof (un_addr->sun_path)) {
+        NVGSTDS_ERR_MSG_V ("Invalid telemetry socket path '%s'", config->path);
+        return FALSE;
+      }
+      un_addr->sun_family = AF_UNIX;
+      strcpy (un_addr->sun_path, config->path);
+      ctx->addr_len = sizeof (*un_addr);
+      ctx->sock = socket (PF_UNIX, SOCK_DGRAM, 0);
+      break;
+    default:
+      NVGSTDS_ERR_MSG_V ("Unknown telemetry type %d", config->type);
+      return FALSE;
+  }
+
+  if (ctx->sock == -1) {
+    NVGSTDS_ERR_MSG_V ("socket() failed");
+    return FALSE;
+  }
+
+  if (config->type == NV_DS_TELEMETRY_UDP_MULTICAST) {
+    guchar ttl = config->multicast_ttl ? config->multicast_ttl : 1;
+    struct in_addr iface;
+
+    if (setsockopt (ctx->sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl,
+            sizeof (ttl)) < 0) {
+      NVGSTDS_ERR_MSG_V ("Failed to set multicast ttl");
+      return FALSE;
+    }
+    if (config->multicast_iface) {
+      if (!inet_aton (config->multicast_iface, &iface) ||
+          setsockopt (ctx->sock, IPPROTO_IP, IP_MULTICAST_IF, &iface,
+              sizeof (iface)) < 0) {
+        NVGSTDS_ERR_MSG_V ("Failed to set multicast interface '%s'",
+            config->multicast_iface);
+        return FALSE;
+      }
+    }
+  }
+  return TRUE;
+}
+
+static gpointer
+telemetry_thread_func (gpointer data)
+{
+  NvDsTelemetryCtx *ctx = (NvDsTelemetryCtx *) data;
+  gint64 period = ctx->config.period_ms * G_TIME_SPAN_MILLISECOND;
+  gint64 next_tick = g_get_monotonic_time () + period;
+  NvDsTelemetrySample sample;
+  guint i;
+
+  while (!g_atomic_int_get (&ctx->stop)) {
+    gint64 now;
+
+    /* Everything queued since the last wake up goes out in as few
+     * sendmmsg() calls as possible. */
+    while (spsc_ring_pop (&ctx->ring, &sample)) {
+      NvDsTelemetryStream *stream =
+          telemetry_stream_get (ctx, sample.stream_id);
+      if (!stream)
+        continue;
+      stream->last = sample;
+      if (ctx->config.event_driven)
+        telemetry_queue_sample (ctx, stream);
+    }
+    if (ctx->num_msgs) {
+      telemetry_flush (ctx);
+      next_tick = g_get_monotonic_time () + period;
+    }
+
+    /* Periodic mode, or heartbeat when no new sample came in for a full
+     * period. */
+    now = g_get_monotonic_time ();
+    if (now >= next_tick) {
+      for (i = 0; i < ctx->num_active; i++)
+        telemetry_queue_sample (ctx, ctx->streams[ctx->active[i]]);
+      telemetry_flush (ctx);
+      next_tick += period;
+      if (next_tick <= now)
+        next_tick = now + period;
+      continue;
+    }
+
+    g_mutex_lock (&ctx->lock);
+    g_atomic_int_set (&ctx->waiting, 1);
+    __atomic_thread_fence (__ATOMIC_SEQ_CST);
+    if (!spsc_ring_count (&ctx->ring) && !g_atomic_int_get (&ctx->stop))
+      g_cond_wait_until (&ctx->cond, &ctx->lock, next_tick);
+    g_atomic_int_set (&ctx->waiting, 0);
+    g_mutex_unlock (&ctx->lock);
+  }
+  return NULL;
+}
+
+void
+telemetry_config_set_defaults (NvDsTelemetryConfig * config)
+{
+  memset (config, 0, sizeof (*config));
+  config->enable = TRUE;
+  config->type = NV_DS_TELEMETRY_UDP;
+  config->host = g_strdup (TELEMETRY_DEFAULT_HOST);
+  config->port = TELEMETRY_DEFAULT_PORT;
+  config->period_ms = TELEMETRY_DEFAULT_PERIOD_MS;
+  config->event_driven = FALSE;
+  config->format = NV_DS_TELEMETRY_FORMAT_LEGACY;
+  config->stream_id = 0;
+  config->latency_compensation = FALSE;
+}
+
+void
+telemetry_config_clear (NvDsTelemetryConfig * config)
+{
+  g_free (config->host);
+  g_free (config->multicast_iface);
+  g_free (config->path);
+  config->host = NULL;
+  config->multicast_iface = NULL;
+  config->path = NULL;
+}
+
+static void
+telemetry_ctx_free (NvDsTelemetryCtx * ctx)
+{
+  guint i;
+
+  if (ctx->sock >= 0)
+    close (ctx->sock);
+  spsc_ring_deinit (&ctx->ring);
+  for (i = 0; i < ctx->num_active; i++)
+    g_free (ctx->streams[ctx->active[i]]);
+  telemetry_config_clear (&ctx->config);
+  g_free (ctx);
+}
+
+NvDsTelemetryCtx *
+start_telemetry_sender (NvDsTelemetryConfig * config)
+{
+  NvDsTelemetryCtx *ctx = g_new0 (NvDsTelemetryCtx, 1);
+  guint i;
+
+  ctx->config = *config;
+  ctx->config.host = g_strdup (config->host);
+  ctx->config.multicast_iface = g_strdup (config->multicast_iface);
+  ctx->config.path = g_strdup (config->path);
+  ctx->sock = -1;
+  if (!ctx->config.period_ms)
+    ctx->config.period_ms = TELEMETRY_DEFAULT_PERIOD_MS;
+
+  if (ctx->config.format == NV_DS_TELEMETRY_FORMAT_LEGACY &&
+      (ctx->config.stream_id < 0 || ctx->config.stream_id >= MAX_SOURCE_BINS)) {
+    NVGSTDS_ERR_MSG_V ("Legacy telemetry format needs a single stream-id");
+    goto error;
+  }
+
+  if (!telemetry_open_socket (ctx))
+    goto error;
+
+  for (i = 0; i < TELEMETRY_BATCH_SIZE; i++) {
+    ctx->iovs[i].iov_base = ctx->packets[i];
+    ctx->msgs[i].msg_hdr.msg_name = &ctx->addr;
+    ctx->msgs[i].msg_hdr.msg_namelen = ctx->addr_len;
+    ctx->msgs[i].msg_hdr.msg_iov = &ctx->iovs[i];
+    ctx->msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  /* The legacy receiver expects a packet every period even before the
+   * first frame, reporting the target as lost. */
+  if (ctx->config.format == NV_DS_TELEMETRY_FORMAT_LEGACY)
+    telemetry_stream_get (ctx, ctx->config.stream_id);
+
+  if (!spsc_ring_init (&ctx->ring, sizeof (NvDsTelemetrySample),
+          TELEMETRY_RING_SIZE)) {
+    NVGSTDS_ERR_MSG_V ("Failed to allocate telemetry ring");
+    goto error;
+  }
+
+  g_mutex_init (&ctx->lock);
+  g_cond_init (&ctx->cond);
+  ctx->thread = g_thread_new ("nvds-telemetry-sender", telemetry_thread_func,
+      ctx);
+  return ctx;
+
+error:
+  telemetry_ctx_free (ctx);
+  return NULL;
+}
+
+void
+telemetry_push (NvDsTelemetryCtx * ctx, const NvDsTelemetrySample * sample)
+{
+  if (ctx->config.stream_id != TELEMETRY_ALL_STREAMS &&
+      sample->stream_id != (guint) ctx->config.stream_id)
+    return;
+
+  if (!spsc_ring_push (&ctx->ring, sample)) {
+    g_atomic_int_inc (&ctx->dropped);
+    return;
+  }
+
+  if (!ctx->config.event_driven)
+    return;
+
+  /* Pairs with the fence in the sender: either it sees the new sample
+   * before sleeping or we see it waiting. */
+  __atomic_thread_fence (__ATOMIC_SEQ_CST);
+  if (g_atomic_int_get (&ctx->waiting)) {
+    g_mutex_lock (&ctx->lock);
+    g_cond_signal (&ctx->cond);
+    g_mutex_unlock (&ctx->lock);
+  }
+}
+
+void
+telemetry_get_stats (NvDsTelemetryCtx * ctx, guint * queued,
+    guint * dropped)
+{
+  *queued = spsc_ring_count (&ctx->ring);
+  *dropped = g_atomic_int_get (&ctx->dropped);
+}
+
+void
+stop_telemetry_sender (NvDsTelemetryCtx * ctx)
+{
+  if (!ctx)
+    return;
+
+  g_mutex_lock (&ctx->lock);
+  g_atomic_int_set (&ctx->stop, 1);
+  g_cond_signal (&ctx->cond);
+  g_mutex_unlock (&ctx->lock);
+  g_thread_join (ctx->thread);
+
+  if (ctx->dropped)
+    NVGSTDS_WARN_MSG_V ("%d telemetry samples dropped", ctx->dropped);
+  if (ctx->send_errors)
+    NVGSTDS_WARN_MSG_V ("%u telemetry datagrams could not be sent",
+        ctx->send_errors);
+
+  g_mutex_clear (&ctx->lock);
+  g_cond_clear (&ctx->cond);
+  telemetry_ctx_free (ctx);
+}
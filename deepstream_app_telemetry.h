@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_TELEMETRY_H__
+#define __NVGSTDS_APP_TELEMETRY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+#include "deepstream_app_target.h"
+
+/** Number of samples the streaming thread may queue ahead of the sender. */
+#define TELEMETRY_RING_SIZE 64
+/** Number of datagrams handed to the kernel with one sendmmsg() call. */
+#define TELEMETRY_BATCH_SIZE 16
+/** Number of [telemetry<N>] destinations per instance. */
+#define MAX_TELEMETRY_DESTINATIONS 8
+
+/** Destination used when the config file has no telemetry group. */
+#define TELEMETRY_DEFAULT_HOST "127.0.0.1"
+#define TELEMETRY_DEFAULT_PORT 44666
+#define TELEMETRY_DEFAULT_PERIOD_MS 40
+/** stream_id value that selects every stream. */
+#define TELEMETRY_ALL_STREAMS -1
+
+/**
+ * Framed wire format, all fields little endian and without padding.
+ *
+ * Header, TELEMETRY_HEADER_SIZE bytes:
+ *   0  u16 magic, TELEMETRY_MAGIC
+ *   2  u8  version, TELEMETRY_WIRE_VERSION
+ *   3  u8  flags, TELEMETRY_FLAG_*
+ *   4  u32 sequence number, incremented per datagram
+ *   8  u64 buffer PTS in ns
+ *   16 u16 stream id (pad index)
+ *   18 u8  number of target records following the header
+ *   19 u8  reserved
+ *
+ * Target record, TELEMETRY_TARGET_SIZE bytes, the followed target first:
+ *   0  u64 tracker object id
+ *   8  f32 center x relative to the frame center
+ *   12 f32 center y relative to the frame center, pointing up
+ *   16 f32 width
+ *   20 f32 height
+ *
+ * Positions and sizes are in pixels of the frame scaled to
+ * TARGET_REFERENCE_HEIGHT lines, in both formats.
+ *   24 u8  detect flag
+ *   25 u8  reserved[3]
+ */
+#define TELEMETRY_FLAG_DETECTED (1 << 0)
+/** Followed target is predicted through a dropout. */
+#define TELEMETRY_FLAG_COASTING (1 << 1)
+/** Followed target is extrapolated from the frame PTS to the send time. */
+#define TELEMETRY_FLAG_EXTRAPOLATED (1 << 2)
+
+#define TELEMETRY_MAGIC 0x5444
+#define TELEMETRY_WIRE_VERSION 1
+#define TELEMETRY_HEADER_SIZE 20
+#define TELEMETRY_TARGET_SIZE 28
+#define TELEMETRY_MAX_PACKET_SIZE \
+  (TELEMETRY_HEADER_SIZE + TARGET_MAX_PUBLISHED * TELEMETRY_TARGET_SIZE)
+
+typedef enum
+{
+  /** 17 byte packet with the followed target of one stream only. */
+  NV_DS_TELEMETRY_FORMAT_LEGACY,
+  /** Framed packet with all published targets of the selected streams. */
+  NV_DS_TELEMETRY_FORMAT_FRAMED,
+} NvDsTelemetryFormat;
+
+typedef enum
+{
+  NV_DS_TELEMETRY_UDP = 1,
+  NV_DS_TELEMETRY_UDP_MULTICAST,
+  /** Datagram socket bound by a process on the same host. */
+  NV_DS_TELEMETRY_UNIX,
+} NvDsTelemetryType;
+
+typedef struct
+{
+  gboolean enable;
+  NvDsTelemetryType type;
+  /** Destination address for the UDP types. */
+  gchar *host;
+  guint port;
+  /** Outgoing interface address and hop limit for multicast. */
+  gchar *multicast_iface;
+  guint multicast_ttl;
+  /** Socket path for NV_DS_TELEMETRY_UNIX. */
+  gchar *path;
+  /** Send interval; heartbeat interval in event driven mode. */
+  guint period_ms;
+  /** Send as soon as the analytics probe publishes a new sample instead of
+   *  every period_ms. Off by default, as the legacy mission program expects
+   *  the fixed rate. */
+  gboolean event_driven;
+  NvDsTelemetryFormat format;
+  /** Move the followed target along its velocity up to the send time. Off
+   *  by default; only the framed format tells the receiver, through
+   *  TELEMETRY_FLAG_EXTRAPOLATED. */
+  gboolean latency_compensation;
+  /** Only samples of this stream are sent, or TELEMETRY_ALL_STREAMS. The
+   *  legacy format carries no stream id and needs a single stream. */
+  gint stream_id;
+} NvDsTelemetryConfig;
+
+/** Targets of one frame as handed from the analytics probe to the sender. */
+typedef struct
+{
+  guint stream_id;
+  guint64 frame_num;
+  guint64 pts;
+  /** Monotonic time in us the frame was captured, 0 if unknown. */
+  gint64 capture_time;
+  NvDsTargetSet set;
+} NvDsTelemetrySample;
+
+typedef struct _NvDsTelemetryCtx NvDsTelemetryCtx;
+
+/**
+ * Open the socket of one destination and start its sender thread.
+ *
+ * @param[in] config destination configuration, copied.
+ *
+ * @return the sender context or NULL on failure.
+ */
+NvDsTelemetryCtx *start_telemetry_sender (NvDsTelemetryConfig * config);
+
+/**
+ * Queue a sample for the sender thread. Never blocks; the sample is dropped
+ * if the sender fell behind. Called from the streaming thread.
+ */
+void telemetry_push (NvDsTelemetryCtx * ctx, const NvDsTelemetrySample * sample);
+
+/**
+ * Samples waiting for the sender and dropped so far, from any thread.
+ */
+void telemetry_get_stats (NvDsTelemetryCtx * ctx, guint * queued,
+    guint * dropped);
+
+/** Fill @p config with the destination used before it was configurable. */
+void telemetry_config_set_defaults (NvDsTelemetryConfig * config);
+
+/** Free the strings of @p config, it can be filled again afterwards. */
+void telemetry_config_clear (NvDsTelemetryConfig * config);
+
+/** Stop the sender thread and release the context. */
+void stop_telemetry_sender (NvDsTelemetryCtx * ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
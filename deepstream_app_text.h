@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __NVGSTDS_APP_TEXT_H__
+#define __NVGSTDS_APP_TEXT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <gst/gst.h>
+
+/** Longest display text of one object, including the terminator. */
+#define TEXT_MAX_LEN 128
+
+/**
+ * Display text being built on the stack. The result is copied to the heap
+ * once, as the object meta release g_free()s display_text whatever the
+ * order the buffer's metas are freed in.
+ */
+typedef struct
+{
+  gchar str[TEXT_MAX_LEN];
+  gsize len;
+} NvDsText;
+
+static inline void
+text_begin (NvDsText * text)
+{
+  text->len = 0;
+  text->str[0] = '\0';
+}
+
+/** Append to a text, truncating at TEXT_MAX_LEN. */
+void text_append (NvDsText * text, const gchar * format, ...)
+    G_GNUC_PRINTF (2, 3);
+
+/** Finish a text, the result is owned by the caller. */
+static inline gchar *
+text_end (NvDsText * text)
+{
+  return g_strndup (text->str, text->len);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
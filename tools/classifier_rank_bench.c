@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Cost of ordering the classifiers of an object for its display text:
+ * the per object g_list_sort() by component id process_meta used to do,
+ * against the rank table placement of classifier_rank_order(). Objects
+ * carry 1 to 16 classifiers from 16 secondary GIEs, attached in random
+ * order.
+ *
+ *   classifier-rank-bench [objects]
+ *
+ * Both variants restore the attach order of the list before every object,
+ * as each new batch arrives unsorted.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../deepstream_app_classifier_rank.h"
+
+#define NUM_GIES 16
+#define FIRST_GIE_ID 2
+#define MIN_SECONDS 0.2
+
+typedef struct
+{
+  NvDsObjectMeta obj;
+  NvDsClassifierMeta *metas;
+  GList *nodes;
+  guint num;
+} BenchObject;
+
+static const guint num_classifiers[] = { 1, 2, 4, 8, 12, 16 };
+
+static gdouble
+now_seconds (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static gint
+component_id_compare_func (gconstpointer a, gconstpointer b)
+{
+  NvDsClassifierMeta *cmetaa = (NvDsClassifierMeta *) a;
+  NvDsClassifierMeta *cmetab = (NvDsClassifierMeta *) b;
+
+  if (cmetaa->unique_component_id < cmetab->unique_component_id)
+    return -1;
+  if (cmetaa->unique_component_id > cmetab->unique_component_id)
+    return 1;
+  return 0;
+}
+
+/* Put the list back in attach order. */
+static inline void
+relink (BenchObject * object)
+{
+  guint i;
+
+  for (i = 0; i < object->num; i++) {
+    object->nodes[i].prev = i ? &object->nodes[i - 1] : NULL;
+    object->nodes[i].next = i + 1 < object->num ? &object->nodes[i + 1] : NULL;
+  }
+  object->obj.classifier_meta_list = &object->nodes[0];
+}
+
+static void
+object_init (BenchObject * object, guint num)
+{
+  guint ids[NUM_GIES], i;
+
+  for (i = 0; i < NUM_GIES; i++)
+    ids[i] = FIRST_GIE_ID + i;
+  for (i = NUM_GIES - 1; i > 0; i--) {
+    guint j = rand () % (i + 1), tmp = ids[i];
+    ids[i] = ids[j];
+    ids[j] = tmp;
+  }
+
+  memset (object, 0, sizeof (*object));
+  object->num = num;
+  object->metas = g_new0 (NvDsClassifierMeta, num);
+  object->nodes = g_new0 (GList, num);
+  for (i = 0; i < num; i++) {
+    object->metas[i].unique_component_id = ids[i];
+    object->nodes[i].data = &object->metas[i];
+  }
+  relink (object);
+}
+
+static void
+object_clear (BenchObject * object)
+{
+  g_free (object->metas);
+  g_free (object->nodes);
+}
+
+static guintptr
+run_sort (BenchObject * objects, guint num_objects)
+{
+  guintptr sum = 0;
+  guint i;
+
+  for (i = 0; i < num_objects; i++) {
+    relink (&objects[i]);
+    objects[i].obj.classifier_meta_list =
+        g_list_sort (objects[i].obj.classifier_meta_list,
+        component_id_compare_func);
+    for (GList * l = objects[i].obj.classifier_meta_list; l; l = l->next)
+      sum += (guintptr) l->data;
+  }
+  return sum;
+}
+
+static guintptr
+run_rank (const NvDsClassifierRank * rank, BenchObject * objects,
+    guint num_objects)
+{
+  NvDsClassifierMeta *ordered[MAX_OBJECT_CLASSIFIERS];
+  guintptr sum = 0;
+  guint i, j, num;
+
+  for (i = 0; i < num_objects; i++) {
+    relink (&objects[i]);
+    num = classifier_rank_order (rank, &objects[i].obj, ordered);
+    for (j = 0; j < num; j++)
+      sum += (guintptr) ordered[j];
+  }
+  return sum;
+}
+
+/* Both orders must agree before their cost is compared. */
+static gboolean
+check_order (const NvDsClassifierRank * rank, BenchObject * object)
+{
+  NvDsClassifierMeta *ordered[MAX_OBJECT_CLASSIFIERS];
+  guint num, i = 0;
+
+  num = classifier_rank_order (rank, &object->obj, ordered);
+  run_sort (object, 1);
+  for (GList * l = object->obj.classifier_meta_list; l; l = l->next, i++) {
+    if (i >= num || l->data != ordered[i])
+      return FALSE;
+  }
+  return i == num;
+}
+
+int
+main (int argc, char *argv[])
+{
+  NvDsClassifierRank rank;
+  guint ids[NUM_GIES + 1];
+  guint num_objects = 1024, c, i;
+  volatile guintptr sink = 0;
+
+  if (argc > 2) {
+    fprintf (stderr, "Usage: %s [objects]\n", argv[0]);
+    return 1;
+  }
+  if (argc > 1)
+    num_objects = MAX (atoi (argv[1]), 1);
+
+  /* The primary GIE and the secondary GIEs, as init_classifier_rank()
+   * registers them. */
+  ids[0] = 1;
+  for (i = 0; i < NUM_GIES; i++)
+    ids[i + 1] = FIRST_GIE_ID + i;
+  classifier_rank_init (&rank, ids, NUM_GIES + 1);
+  srand (1);
+
+  printf ("%u objects per pass\n", num_objects);
+  printf ("classifiers  g_list_sort ns/obj  rank ns/obj  speedup\n");
+  for (c = 0; c < G_N_ELEMENTS (num_classifiers); c++) {
+    BenchObject *objects = g_new (BenchObject, num_objects);
+    gdouble start, sort_ns, rank_ns;
+    guint passes;
+
+    for (i = 0; i < num_objects; i++)
+      object_init (&objects[i], num_classifiers[c]);
+    for (i = 0; i < num_objects; i++) {
+      if (!check_order (&rank, &objects[i])) {
+        fprintf (stderr, "orders differ with %u classifiers\n",
+            num_classifiers[c]);
+        return 2;
+      }
+    }
+
+    start = now_seconds ();
+    for (passes = 0; now_seconds () - start < MIN_SECONDS; passes++)
+      sink += run_sort (objects, num_objects);
+    sort_ns = (now_seconds () - start) * 1e9 / passes / num_objects;
+
+    start = now_seconds ();
+    for (passes = 0; now_seconds () - start < MIN_SECONDS; passes++)
+      sink += run_rank (&rank, objects, num_objects);
+    rank_ns = (now_seconds () - start) * 1e9 / passes / num_objects;
+
+    printf ("%11u  %18.1f  %11.1f  %6.2fx\n", num_classifiers[c], sort_ns,
+        rank_ns, sort_ns / rank_ns);
+
+    for (i = 0; i < num_objects; i++)
+      object_clear (&objects[i]);
+    g_free (objects);
+  }
+  (void) sink;
+  return 0;
+}
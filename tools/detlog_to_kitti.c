@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+
+/*
+ * Convert a columnar detection log written with kitti-output-format=1 back
+ * to one KITTI text file per stream and frame, as written with the text
+ * format.
+ *
+ *   detlog-to-kitti [-t] <log.ndl> <output-dir>
+ *
+ * -t adds the tracking id column, as in kitti-track-output-dir files.
+ * Frames logged without detections get an empty file, as with the text
+ * format; logs of version 1 do not record those frames.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../deepstream_app_detlog_format.h"
+
+/* Set of (stream, frame) files already started by this run. */
+typedef struct
+{
+  uint64_t *keys;
+  size_t mask;
+  size_t count;
+} FrameSet;
+
+#define FRAME_SET_EMPTY UINT64_MAX
+
+static int
+frame_set_insert (FrameSet * set, uint64_t key)
+{
+  size_t pos;
+
+  if ((set->count + 1) * 2 > set->mask + 1) {
+    FrameSet grown = { 0 };
+    size_t i;
+
+    grown.mask = set->mask ? set->mask * 2 + 1 : 1023;
+    grown.keys = malloc ((grown.mask + 1) * sizeof (uint64_t));
+    if (!grown.keys)
+      return -1;
+    memset (grown.keys, 0xff, (grown.mask + 1) * sizeof (uint64_t));
+    for (i = 0; set->keys && i <= set->mask; i++) {
+      if (set->keys[i] != FRAME_SET_EMPTY)
+        frame_set_insert (&grown, set->keys[i]);
+    }
+    free (set->keys);
+    *set = grown;
+  }
+
+  for (pos = (key * 0x9E3779B97F4A7C15ULL) & set->mask;
+      set->keys[pos] != FRAME_SET_EMPTY; pos = (pos + 1) & set->mask) {
+    if (set->keys[pos] == key)
+      return 0;
+  }
+  set->keys[pos] = key;
+  set->count++;
+  return 1;
+}
+
+typedef struct
+{
+  const char *out_dir;
+  uint32_t instance;
+  int with_ids;
+  FrameSet started;
+  FILE *file;
+  uint64_t file_key;
+  uint64_t num_rows;
+} Converter;
+
+static int
+convert_row (Converter * conv, uint32_t stream_id, uint64_t frame_num,
+    const char *label, uint64_t object_id, float left, float top,
+    float width, float height)
+{
+  uint64_t key = ((uint64_t) stream_id << 40) | (frame_num & 0xffffffffffULL);
+
+  if (!conv->file || conv->file_key != key) {
+    char path[4096];
+    int first;
+
+    if (conv->file)
+      fclose (conv->file);
+    conv->file = NULL;
+
+    first = frame_set_insert (&conv->started, key);
+    if (first < 0)
+      return -1;
+    snprintf (path, sizeof (path), "%s/%02u_%03u_%06lu.txt", conv->out_dir,
+        conv->instance, stream_id, (unsigned long) frame_num);
+    conv->file = fopen (path, first ? "w" : "a");
+    if (!conv->file) {
+      fprintf (stderr, "Cannot open %s: %s\n", path, strerror (errno));
+      return -1;
+    }
+    conv->file_key = key;
+  }
+
+  /* Frame without detections, the file is only created. */
+  if (!label)
+    return 0;
+
+  if (conv->with_ids)
+    fprintf (conv->file,
+        "%s %lu 0.0 0 0.0 %f %f %f %f 0.0 0.0 0.0 0.0 0.0 0.0 0.0\n", label,
+        (unsigned long) object_id, left, top, left + width, top + height);
+  else
+    fprintf (conv->file,
+        "%s 0.0 0 0.0 %f %f %f %f 0.0 0.0 0.0 0.0 0.0 0.0 0.0\n", label,
+        left, top, left + width, top + height);
+  conv->num_rows++;
+  return 0;
+}
+
+/** Returns the chunk size, 0 if no valid chunk starts at @p offset. */
+static size_t
+convert_chunk (Converter * conv, const uint8_t * base, size_t size,
+    size_t offset)
+{
+  const NvDsDetLogChunkHeader *header;
+  NvDsDetLogChunkLayout layout;
+  const uint64_t *frame_num, *object_id;
+  const uint32_t *stream_id;
+  const uint16_t *label;
+  const float *left, *top, *width, *height;
+  const char *labels;
+  uint32_t i;
+
+  if (offset + sizeof (*header) > size)
+    return 0;
+  header = (const NvDsDetLogChunkHeader *) (base + offset);
+  if (header->magic != DETLOG_CHUNK_MAGIC
+      || header->num_rows > DETLOG_CHUNK_ROWS
+      || header->num_labels > DETLOG_MAX_LABELS)
+    return 0;
+
+  detlog_chunk_layout (header->num_rows, header->num_labels, &layout);
+  if (offset + layout.size > size)
+    return 0;
+
+  base += offset;
+  frame_num = (const uint64_t *) (base + layout.frame_num);
+  object_id = (const uint64_t *) (base + layout.object_id);
+  stream_id = (const uint32_t *) (base + layout.stream_id);
+  label = (const uint16_t *) (base + layout.label);
+  left = (const float *) (base + layout.left);
+  top = (const float *) (base + layout.top);
+  width = (const float *) (base + layout.width);
+  height = (const float *) (base + layout.height);
+  labels = (const char *) (base + layout.labels);
+
+  for (i = 0; i < header->num_rows; i++) {
+    char name[DETLOG_LABEL_SIZE] = "";
+
+    if (label[i] < header->num_labels)
+      memcpy (name, labels + (size_t) label[i] * DETLOG_LABEL_SIZE,
+          DETLOG_LABEL_SIZE - 1);
+    if (convert_row (conv, stream_id[i], frame_num[i],
+            label[i] == DETLOG_NO_OBJECT ? NULL : name, object_id[i],
+            left[i], top[i], width[i], height[i]) < 0)
+      return 0;
+  }
+  return layout.size;
+}
+
+static int
+convert (Converter * conv, const uint8_t * base, size_t size)
+{
+  const NvDsDetLogFileHeader *header = (const NvDsDetLogFileHeader *) base;
+  const NvDsDetLogTrailer *trailer;
+  size_t offset;
+
+  if (size >= sizeof (*header)
+      && header->byte_order == __builtin_bswap32 (DETLOG_BYTE_ORDER)) {
+    fprintf (stderr, "Log was written on a host of another byte order\n");
+    return -1;
+  }
+  if (size < sizeof (*header) || header->magic != DETLOG_FILE_MAGIC
+      || header->version < 1 || header->version > DETLOG_VERSION
+      || (header->version >= 2 && header->byte_order != DETLOG_BYTE_ORDER)) {
+    fprintf (stderr, "Not a detection log\n");
+    return -1;
+  }
+  conv->instance = header->instance;
+
+  /* Use the index when the log was closed cleanly. */
+  trailer = (const NvDsDetLogTrailer *) (base + size - sizeof (*trailer));
+  if (size >= sizeof (*header) + sizeof (*trailer)
+      && trailer->magic == DETLOG_INDEX_MAGIC
+      && trailer->index_offset + (uint64_t) trailer->num_chunks *
+      sizeof (NvDsDetLogIndexEntry) + sizeof (*trailer) == size) {
+    const NvDsDetLogIndexEntry *index =
+        (const NvDsDetLogIndexEntry *) (base + trailer->index_offset);
+    uint32_t i;
+
+    for (i = 0; i < trailer->num_chunks; i++) {
+      if (!convert_chunk (conv, base, trailer->index_offset, index[i].offset)) {
+        fprintf (stderr, "Bad chunk at offset %lu\n",
+            (unsigned long) index[i].offset);
+        return -1;
+      }
+    }
+    return 0;
+  }
+
+  fprintf (stderr, "No index, scanning chunks\n");
+  offset = sizeof (*header);
+  while (offset < size) {
+    size_t chunk_size = convert_chunk (conv, base, size, offset);
+    if (!chunk_size)
+      break;
+    offset += chunk_size;
+  }
+  if (offset < size)
+    fprintf (stderr, "Stopped at offset %lu of %lu, log is truncated\n",
+        (unsigned long) offset, (unsigned long) size);
+  return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+  Converter conv = { 0 };
+  struct stat st;
+  void *base;
+  int argi = 1;
+  int fd, ret;
+
+  if (argc > 1 && !strcmp (argv[1], "-t")) {
+    conv.with_ids = 1;
+    argi++;
+  }
+  if (argc - argi != 2) {
+    fprintf (stderr, "Usage: %s [-t] <log.ndl> <output-dir>\n", argv[0]);
+    return 1;
+  }
+  conv.out_dir = argv[argi + 1];
+
+  fd = open (argv[argi], O_RDONLY);
+  if (fd < 0 || fstat (fd, &st) < 0) {
+    fprintf (stderr, "Cannot open %s: %s\n", argv[argi], strerror (errno));
+    return 1;
+  }
+  if (st.st_size == 0) {
+    fprintf (stderr, "Not a detection log\n");
+    return 1;
+  }
+  base = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (base == MAP_FAILED) {
+    fprintf (stderr, "Cannot map %s: %s\n", argv[argi], strerror (errno));
+    return 1;
+  }
+
+  ret = convert (&conv, base, st.st_size);
+  if (conv.file)
+    fclose (conv.file);
+  munmap (base, st.st_size);
+  free (conv.started.keys);
+
+  if (ret < 0)
+    return 1;
+  printf ("%lu detections converted\n", (unsigned long) conv.num_rows);
+  return 0;
+}
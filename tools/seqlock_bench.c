@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2018-2020, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Reader and writer latency of the target snapshot seqlock under
+ * contention. One writer publishes a snapshot the size of NvDsTargetSet
+ * while readers copy it in a loop, as the telemetry senders, overlay and
+ * ROI probe do.
+ *
+ *   seqlock-bench [readers] [seconds] [writer-period-us]
+ *
+ * A writer period of 0 publishes back to back, the worst case for readers.
+ * Readers check every copy for tearing.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../deepstream_app_seqlock.h"
+#include "../deepstream_app_target.h"
+
+#define PAYLOAD_WORDS (sizeof (NvDsTargetSet) / sizeof (guint64))
+#define MAX_READERS 64
+/* Latency histogram in powers of two nanoseconds. */
+#define NUM_BUCKETS 40
+
+typedef struct
+{
+  gint seq;
+  guint64 words[PAYLOAD_WORDS];
+} Snapshot;
+
+/* Same size and layout as NvDsTargetSnapshot. */
+G_STATIC_ASSERT (sizeof (NvDsTargetSet) % sizeof (guint64) == 0);
+G_STATIC_ASSERT (sizeof (Snapshot) == sizeof (NvDsTargetSnapshot));
+
+typedef struct
+{
+  guint64 ops;
+  guint64 retries;
+  guint64 torn;
+  guint64 max_ns;
+  guint64 buckets[NUM_BUCKETS];
+} Stats;
+
+typedef struct
+{
+  Snapshot *snapshot;
+  gint stop;
+  guint64 writer_period_ns;
+} Shared;
+
+typedef struct
+{
+  Shared *shared;
+  Stats stats;
+} Worker;
+
+static inline guint64
+now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (guint64) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline void
+stats_add (Stats * stats, guint64 ns)
+{
+  guint bucket = ns ? 64 - __builtin_clzll (ns) : 0;
+
+  stats->ops++;
+  stats->buckets[MIN (bucket, NUM_BUCKETS - 1)]++;
+  if (ns > stats->max_ns)
+    stats->max_ns = ns;
+}
+
+/* Upper bound of the bucket holding the given fraction of the operations. */
+static guint64
+stats_percentile (const Stats * stats, gdouble fraction)
+{
+  guint64 rank = (guint64) (stats->ops * fraction), seen = 0;
+  guint i;
+
+  for (i = 0; i < NUM_BUCKETS; i++) {
+    seen += stats->buckets[i];
+    if (seen > rank)
+      return i ? 1ULL << i : 1;
+  }
+  return stats->max_ns;
+}
+
+static void
+stats_merge (Stats * into, const Stats * from)
+{
+  guint i;
+
+  into->ops += from->ops;
+  into->retries += from->retries;
+  into->torn += from->torn;
+  into->max_ns = MAX (into->max_ns, from->max_ns);
+  for (i = 0; i < NUM_BUCKETS; i++)
+    into->buckets[i] += from->buckets[i];
+}
+
+static gpointer
+writer_thread (gpointer data)
+{
+  Worker *worker = (Worker *) data;
+  Shared *shared = worker->shared;
+  guint64 value = 0, next = now_ns ();
+  guint i;
+
+  while (!g_atomic_int_get (&shared->stop)) {
+    guint64 start;
+
+    if (shared->writer_period_ns) {
+      next += shared->writer_period_ns;
+      while (now_ns () < next);
+    }
+
+    value++;
+    start = now_ns ();
+    seqlock_write_begin (&shared->snapshot->seq);
+    for (i = 0; i < PAYLOAD_WORDS; i++)
+      shared->snapshot->words[i] = value;
+    seqlock_write_end (&shared->snapshot->seq);
+    stats_add (&worker->stats, now_ns () - start);
+  }
+  return NULL;
+}
+
+static gpointer
+reader_thread (gpointer data)
+{
+  Worker *worker = (Worker *) data;
+  Shared *shared = worker->shared;
+  guint64 copy[PAYLOAD_WORDS];
+  guint i;
+
+  while (!g_atomic_int_get (&shared->stop)) {
+    guint64 start = now_ns ();
+    gint seq;
+
+    for (;;) {
+      seq = seqlock_read_begin (&shared->snapshot->seq);
+      memcpy (copy, shared->snapshot->words, sizeof (copy));
+      if (!seqlock_read_retry (&shared->snapshot->seq, seq))
+        break;
+      worker->stats.retries++;
+    }
+    stats_add (&worker->stats, now_ns () - start);
+
+    for (i = 1; i < PAYLOAD_WORDS; i++) {
+      if (copy[i] != copy[0]) {
+        worker->stats.torn++;
+        break;
+      }
+    }
+  }
+  return NULL;
+}
+
+static void
+print_stats (const gchar * name, const Stats * stats, gdouble seconds)
+{
+  printf ("%-7s %12" G_GUINT64_FORMAT " ops %10.0f ops/s  p50 %6"
+      G_GUINT64_FORMAT " ns  p99 %6" G_GUINT64_FORMAT " ns  p99.9 %7"
+      G_GUINT64_FORMAT " ns  max %9" G_GUINT64_FORMAT " ns", name, stats->ops,
+      stats->ops / seconds, stats_percentile (stats, 0.5),
+      stats_percentile (stats, 0.99), stats_percentile (stats, 0.999),
+      stats->max_ns);
+  if (stats->retries || stats->torn)
+    printf ("  retries %" G_GUINT64_FORMAT "  torn %" G_GUINT64_FORMAT,
+        stats->retries, stats->torn);
+  printf ("\n");
+}
+
+int
+main (int argc, char *argv[])
+{
+  Shared shared = { 0 };
+  Worker writer = { 0 };
+  Worker readers[MAX_READERS];
+  GThread *threads[MAX_READERS + 1];
+  Stats total = { 0 };
+  gpointer mem;
+  guint num_readers = 2, seconds = 5, i;
+
+  if (argc > 4) {
+    fprintf (stderr, "Usage: %s [readers] [seconds] [writer-period-us]\n",
+        argv[0]);
+    return 1;
+  }
+  if (argc > 1)
+    num_readers = CLAMP (atoi (argv[1]), 1, MAX_READERS);
+  if (argc > 2)
+    seconds = MAX (atoi (argv[2]), 1);
+  if (argc > 3)
+    shared.writer_period_ns = (guint64) MAX (atoi (argv[3]), 0) * 1000;
+
+  /* Cache line aligned so runs are comparable. NvDsTargetSnapshot itself is
+   * only 8 byte aligned inside NvDsTargetStream and may share a line with
+   * the writer side copy of the set before it. */
+  mem = g_malloc0 (sizeof (Snapshot) + 63);
+  shared.snapshot = (Snapshot *) (((guintptr) mem + 63) & ~(guintptr) 63);
+
+  printf ("%u readers, %u s, writer period %" G_GUINT64_FORMAT " us, "
+      "%u byte payload\n", num_readers, seconds,
+      shared.writer_period_ns / 1000, (guint) sizeof (shared.snapshot->words));
+
+  writer.shared = &shared;
+  memset (readers, 0, sizeof (readers));
+  for (i = 0; i < num_readers; i++) {
+    readers[i].shared = &shared;
+    threads[i] = g_thread_new ("reader", reader_thread, &readers[i]);
+  }
+  threads[num_readers] = g_thread_new ("writer", writer_thread, &writer);
+
+  g_usleep ((gulong) seconds * G_USEC_PER_SEC);
+  g_atomic_int_set (&shared.stop, 1);
+  for (i = 0; i <= num_readers; i++)
+    g_thread_join (threads[i]);
+
+  print_stats ("writer", &writer.stats, seconds);
+  for (i = 0; i < num_readers; i++)
+    stats_merge (&total, &readers[i].stats);
+  print_stats ("readers", &total, seconds);
+  g_free (mem);
+
+  return total.torn ? 2 : 0;
+}